@@ -0,0 +1,206 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include "scenes.hpp"
+#include "benchmark_report.hpp"
+
+// Runs the stress scenes headless with a fixed seed and reports frame time percentiles,
+// per-manager timings, entity counts and peak RSS as JSON.
+//
+// benchmark [--scene <name>]... [--frames <n>] [--seconds <s>] [--seed <n>] [--warmup <n>]
+//           [--output <file>] [--baseline <file>] [--tolerance <fraction>]
+//           [--broadphase <name>]... [--cell-size <size>] [--looseness <factor>]
+//
+// Every scene runs in its own process (this executable with --run-scene) so peak RSS is per
+// scene and no scene state leaks into the next one. With --baseline the exit code is 1 when
+// a frame percentile or peak RSS grew by more than the tolerance (0.1 by default). Every
+// --broadphase runs all scenes again with that ColliderBBManager backend, reported as
+// <scene>/<broadphase>, so backends can be compared in one report.
+
+namespace
+{
+	struct BenchmarkOptions
+	{
+		std::vector<std::string> scenes;
+		unsigned long long frames = 300;
+		float seconds = 0.f;
+		unsigned long long seed = 1;
+		size_t warmup = 10;
+		std::string output;
+		std::string baseline;
+		double tolerance = 0.1;
+		std::vector<std::string> broadphases;
+		float cell_size = 0.f;
+		float looseness = 1.f;
+		// Internal: run one scene in this process and write its report here
+		std::string run_scene;
+		std::string scene_report;
+	};
+
+	BenchmarkOptions ParseBenchmarkOptions(int argc, char** argv)
+	{
+		BenchmarkOptions options;
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			if (arg == "--scene" && i + 1 < argc)
+				options.scenes.push_back(argv[++i]);
+			else if (arg == "--frames" && i + 1 < argc)
+				options.frames = std::stoull(argv[++i]);
+			else if (arg == "--seconds" && i + 1 < argc)
+				options.seconds = std::stof(argv[++i]);
+			else if (arg == "--seed" && i + 1 < argc)
+				options.seed = std::stoull(argv[++i]);
+			else if (arg == "--warmup" && i + 1 < argc)
+				options.warmup = std::stoull(argv[++i]);
+			else if (arg == "--output" && i + 1 < argc)
+				options.output = argv[++i];
+			else if (arg == "--baseline" && i + 1 < argc)
+				options.baseline = argv[++i];
+			else if (arg == "--tolerance" && i + 1 < argc)
+				options.tolerance = std::stod(argv[++i]);
+			else if (arg == "--broadphase" && i + 1 < argc)
+				options.broadphases.push_back(argv[++i]);
+			else if (arg == "--cell-size" && i + 1 < argc)
+				options.cell_size = std::stof(argv[++i]);
+			else if (arg == "--looseness" && i + 1 < argc)
+				options.looseness = std::stof(argv[++i]);
+			else if (arg == "--run-scene" && i + 1 < argc)
+				options.run_scene = argv[++i];
+			else if (arg == "--scene-report" && i + 1 < argc)
+				options.scene_report = argv[++i];
+			else
+				std::cerr << "benchmark: ignoring unknown argument " << arg << '\n';
+		}
+		if (options.scenes.empty())
+			for (const auto& scene : GetScenes())
+				options.scenes.push_back(scene.name);
+		return options;
+	}
+
+	const SceneEntry* FindScene(const std::string& name)
+	{
+		const auto& scenes = GetScenes();
+		auto it = std::find_if(scenes.begin(), scenes.end(), [&name](const SceneEntry& scene) { return scene.name == name; });
+		return it == scenes.end() ? nullptr : &*it;
+	}
+
+	int RunSceneProcess(const BenchmarkOptions& options)
+	{
+		const SceneEntry* scene = FindScene(options.run_scene);
+		if (!scene)
+		{
+			std::cerr << "benchmark: unknown scene " << options.run_scene << '\n';
+			return 2;
+		}
+		SceneOptions scene_options;
+		scene_options.headless = true;
+		scene_options.quiet = true;
+		scene_options.frames = options.frames;
+		scene_options.seconds = options.seconds;
+		scene_options.seed = options.seed;
+		scene_options.cell_size = options.cell_size;
+		scene_options.looseness = options.looseness;
+		std::string name = scene->name;
+		if (!options.broadphases.empty())
+		{
+			scene_options.broadphase = options.broadphases.front();
+			name += '/' + scene_options.broadphase;
+		}
+
+		SceneReport report = MakeSceneReport(name, scene->run(scene_options), options.warmup);
+		std::ofstream out(options.scene_report);
+		WriteSceneReport(out, report);
+		return out ? 0 : 2;
+	}
+
+	std::string Quote(const std::string& argument)
+	{
+		return '"' + argument + '"';
+	}
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options = ParseBenchmarkOptions(argc, argv);
+	if (!options.run_scene.empty())
+		return RunSceneProcess(options);
+
+	BenchmarkReport report;
+	report.seed = options.seed;
+	std::vector<std::string> broadphases = options.broadphases;
+	if (broadphases.empty())
+		broadphases.emplace_back();
+	for (const auto& broadphase : broadphases)
+		for (const auto& name : options.scenes)
+		{
+			if (!FindScene(name))
+			{
+				std::cerr << "benchmark: unknown scene " << name << '\n';
+				return 2;
+			}
+			std::string label = broadphase.empty() ? name : name + '/' + broadphase;
+			std::filesystem::path scene_report = std::filesystem::temp_directory_path() / ("benchmark_" + name + ".json");
+			std::string command = Quote(argv[0]) + " --run-scene " + name
+				+ " --frames " + std::to_string(options.frames) + " --seconds " + std::to_string(options.seconds)
+				+ " --seed " + std::to_string(options.seed) + " --warmup " + std::to_string(options.warmup)
+				+ " --cell-size " + std::to_string(options.cell_size) + " --looseness " + std::to_string(options.looseness)
+				+ " --scene-report " + Quote(scene_report.string());
+			if (!broadphase.empty())
+				command += " --broadphase " + broadphase;
+#ifdef _WIN32
+			// cmd.exe strips the outer quotes of a command line starting with a quote
+			command = Quote(command);
+#endif
+			std::cerr << "benchmark: " << label << "...\n";
+			if (std::system(command.c_str()) != 0)
+			{
+				std::cerr << "benchmark: " << label << " failed\n";
+				return 2;
+			}
+			try
+			{
+				report.scenes.push_back(ReadSceneReport(scene_report.string()));
+			}
+			catch (const BenchmarkReportException& e)
+			{
+				std::cerr << "benchmark: " << e.what() << '\n';
+				return 2;
+			}
+			std::filesystem::remove(scene_report);
+		}
+
+	if (options.output.empty())
+		WriteBenchmarkReport(std::cout, report);
+	else
+	{
+		std::ofstream out(options.output);
+		WriteBenchmarkReport(out, report);
+		if (!out)
+		{
+			std::cerr << "benchmark: cannot write " << options.output << '\n';
+			return 2;
+		}
+	}
+
+	if (options.baseline.empty())
+		return 0;
+	try
+	{
+		auto regressions = CompareReports(ReadBenchmarkReport(options.baseline), report, options.tolerance);
+		for (const auto& regression : regressions)
+			std::cerr << "regression: " << regression.scene << ' ' << regression.metric << ' '
+				<< regression.baseline << " -> " << regression.current << '\n';
+		return regressions.empty() ? 0 : 1;
+	}
+	catch (const BenchmarkReportException& e)
+	{
+		std::cerr << "benchmark: baseline " << e.what() << '\n';
+		return 2;
+	}
+}
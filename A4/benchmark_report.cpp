@@ -0,0 +1,323 @@
+#include "benchmark_report.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <numeric>
+#include <variant>
+#include <map>
+#include <memory>
+#include <cmath>
+#include <cctype>
+#include <string_view>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+FrameStatistics ComputeFrameStatistics(std::vector<float> frame_ms, size_t warmup)
+{
+	FrameStatistics statistics;
+	if (frame_ms.size() > warmup)
+		frame_ms.erase(frame_ms.begin(), frame_ms.begin() + warmup);
+	if (frame_ms.empty())
+		return statistics;
+
+	std::sort(frame_ms.begin(), frame_ms.end());
+	auto percentile = [&frame_ms](double p) {
+		size_t rank = static_cast<size_t>(std::ceil(p * frame_ms.size()));
+		return static_cast<double>(frame_ms[std::clamp<size_t>(rank, 1, frame_ms.size()) - 1]);
+		};
+	statistics.frames = frame_ms.size();
+	statistics.mean_ms = std::accumulate(frame_ms.begin(), frame_ms.end(), 0.) / frame_ms.size();
+	statistics.p50_ms = percentile(0.50);
+	statistics.p95_ms = percentile(0.95);
+	statistics.p99_ms = percentile(0.99);
+	statistics.max_ms = frame_ms.back();
+	return statistics;
+}
+
+SceneReport MakeSceneReport(const std::string& name, const SceneResult& result, size_t warmup)
+{
+	SceneReport scene;
+	scene.name = name;
+	scene.frame = ComputeFrameStatistics(result.frame_ms, warmup);
+	for (const auto& timing : result.timings)
+		scene.managers.push_back({ timing.name, timing.average_ms });
+	scene.entities = result.entities;
+	scene.peak_rss_kb = PeakResidentSetKB();
+	return scene;
+}
+
+unsigned long long PeakResidentSetKB()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+namespace
+{
+	std::string Escape(const std::string& text)
+	{
+		std::string escaped;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+				escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+
+	// Minimal JSON reader for the reports this file writes
+	struct JsonValue
+	{
+		std::variant<std::nullptr_t, bool, double, std::string, std::vector<JsonValue>, std::map<std::string, JsonValue>> value;
+
+		const JsonValue& operator[](const std::string& key) const
+		{
+			const auto* object = std::get_if<std::map<std::string, JsonValue>>(&value);
+			if (!object || !object->contains(key))
+				throw BenchmarkReportException("missing key \"" + key + "\"");
+			return object->at(key);
+		}
+		const std::vector<JsonValue>& Array() const
+		{
+			if (const auto* array = std::get_if<std::vector<JsonValue>>(&value))
+				return *array;
+			throw BenchmarkReportException("expected an array");
+		}
+		double Number() const
+		{
+			if (const auto* number = std::get_if<double>(&value))
+				return *number;
+			throw BenchmarkReportException("expected a number");
+		}
+		const std::string& String() const
+		{
+			if (const auto* string = std::get_if<std::string>(&value))
+				return *string;
+			throw BenchmarkReportException("expected a string");
+		}
+	};
+
+	class JsonParser
+	{
+	private:
+		const std::string& m_text;
+		size_t m_pos = 0;
+
+		void SkipSpace()
+		{
+			while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos])))
+				++m_pos;
+		}
+		char Peek()
+		{
+			SkipSpace();
+			if (m_pos >= m_text.size())
+				throw BenchmarkReportException("unexpected end of report");
+			return m_text[m_pos];
+		}
+		void Expect(char c)
+		{
+			if (Peek() != c)
+				throw BenchmarkReportException(std::string("expected '") + c + "' at offset " + std::to_string(m_pos));
+			++m_pos;
+		}
+		std::string ParseString()
+		{
+			Expect('"');
+			std::string result;
+			while (m_pos < m_text.size() && m_text[m_pos] != '"')
+			{
+				if (m_text[m_pos] == '\\' && m_pos + 1 < m_text.size())
+					++m_pos;
+				result += m_text[m_pos++];
+			}
+			Expect('"');
+			return result;
+		}
+		bool TryConsume(char c)
+		{
+			if (Peek() != c)
+				return false;
+			++m_pos;
+			return true;
+		}
+		bool Consume(const char* literal)
+		{
+			std::string_view expected(literal);
+			if (m_text.compare(m_pos, expected.size(), expected) != 0)
+				return false;
+			m_pos += expected.size();
+			return true;
+		}
+	public:
+		JsonParser(const std::string& text) : m_text(text)
+		{}
+
+		JsonValue Parse()
+		{
+			if (TryConsume('{'))
+			{
+				std::map<std::string, JsonValue> object;
+				if (!TryConsume('}'))
+				{
+					do
+					{
+						std::string key = ParseString();
+						Expect(':');
+						object.emplace(std::move(key), Parse());
+					} while (TryConsume(','));
+					Expect('}');
+				}
+				return { std::move(object) };
+			}
+			if (TryConsume('['))
+			{
+				std::vector<JsonValue> array;
+				if (!TryConsume(']'))
+				{
+					do
+						array.push_back(Parse());
+					while (TryConsume(','));
+					Expect(']');
+				}
+				return { std::move(array) };
+			}
+			if (Peek() == '"')
+				return { ParseString() };
+			if (Consume("true"))
+				return { true };
+			if (Consume("false"))
+				return { false };
+			if (Consume("null"))
+				return { nullptr };
+
+			size_t length = 0;
+			double number = std::stod(m_text.substr(m_pos, 32), &length);
+			m_pos += length;
+			return { number };
+		}
+	};
+
+	JsonValue ReadJson(const std::string& path)
+	{
+		std::ifstream file(path);
+		if (!file)
+			throw BenchmarkReportException("cannot open " + path);
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		std::string text = buffer.str();
+		try
+		{
+			return JsonParser(text).Parse();
+		}
+		catch (const std::invalid_argument&)
+		{
+			throw BenchmarkReportException(path + ": malformed number");
+		}
+	}
+
+	SceneReport ParseSceneReport(const JsonValue& json)
+	{
+		SceneReport scene;
+		scene.name = json["name"].String();
+		const JsonValue& frame = json["frame_ms"];
+		scene.frame.frames = static_cast<unsigned long long>(json["frames"].Number());
+		scene.frame.mean_ms = frame["mean"].Number();
+		scene.frame.p50_ms = frame["p50"].Number();
+		scene.frame.p95_ms = frame["p95"].Number();
+		scene.frame.p99_ms = frame["p99"].Number();
+		scene.frame.max_ms = frame["max"].Number();
+		for (const auto& manager : json["managers"].Array())
+			scene.managers.push_back({ manager["name"].String(), manager["average_ms"].Number() });
+		scene.entities = static_cast<unsigned long long>(json["entities"].Number());
+		scene.peak_rss_kb = static_cast<unsigned long long>(json["peak_rss_kb"].Number());
+		return scene;
+	}
+}
+
+void WriteSceneReport(std::ostream& out, const SceneReport& scene, int indent)
+{
+	std::string pad(indent, '\t');
+	out << std::fixed << std::setprecision(4);
+	out << pad << "{\n"
+		<< pad << "\t\"name\": \"" << Escape(scene.name) << "\",\n"
+		<< pad << "\t\"frames\": " << scene.frame.frames << ",\n"
+		<< pad << "\t\"frame_ms\": { \"mean\": " << scene.frame.mean_ms << ", \"p50\": " << scene.frame.p50_ms
+		<< ", \"p95\": " << scene.frame.p95_ms << ", \"p99\": " << scene.frame.p99_ms << ", \"max\": " << scene.frame.max_ms << " },\n"
+		<< pad << "\t\"managers\": [";
+	for (size_t i = 0; i < scene.managers.size(); ++i)
+		out << (i ? ",\n" : "\n") << pad << "\t\t{ \"name\": \"" << Escape(scene.managers[i].name) << "\", \"average_ms\": " << scene.managers[i].average_ms << " }";
+	out << '\n' << pad << "\t],\n"
+		<< pad << "\t\"entities\": " << scene.entities << ",\n"
+		<< pad << "\t\"peak_rss_kb\": " << scene.peak_rss_kb << '\n'
+		<< pad << "}";
+}
+
+void WriteBenchmarkReport(std::ostream& out, const BenchmarkReport& report)
+{
+	out << "{\n\t\"seed\": " << report.seed << ",\n\t\"scenes\": [";
+	for (size_t i = 0; i < report.scenes.size(); ++i)
+	{
+		out << (i ? ",\n" : "\n");
+		WriteSceneReport(out, report.scenes[i], 2);
+	}
+	out << "\n\t]\n}\n";
+}
+
+SceneReport ReadSceneReport(const std::string& path)
+{
+	return ParseSceneReport(ReadJson(path));
+}
+
+BenchmarkReport ReadBenchmarkReport(const std::string& path)
+{
+	JsonValue json = ReadJson(path);
+	BenchmarkReport report;
+	report.seed = static_cast<unsigned long long>(json["seed"].Number());
+	for (const auto& scene : json["scenes"].Array())
+		report.scenes.push_back(ParseSceneReport(scene));
+	return report;
+}
+
+std::vector<Regression> CompareReports(const BenchmarkReport& baseline, const BenchmarkReport& current, double tolerance)
+{
+	std::vector<Regression> regressions;
+	for (const auto& scene : current.scenes)
+	{
+		auto base = std::find_if(baseline.scenes.begin(), baseline.scenes.end(), [&scene](const SceneReport& s) { return s.name == scene.name; });
+		if (base == baseline.scenes.end())
+			continue;
+		auto check = [&](const char* metric, double before, double after) {
+			if (before > 0. && after > before * (1. + tolerance))
+				regressions.push_back({ scene.name, metric, before, after });
+			};
+		check("p50_ms", base->frame.p50_ms, scene.frame.p50_ms);
+		check("p95_ms", base->frame.p95_ms, scene.frame.p95_ms);
+		check("p99_ms", base->frame.p99_ms, scene.frame.p99_ms);
+		check("peak_rss_kb", static_cast<double>(base->peak_rss_kb), static_cast<double>(scene.peak_rss_kb));
+	}
+	return regressions;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <ostream>
+#include <exception>
+
+#include "scene.hpp"
+
+class BenchmarkReportException : public std::exception
+{
+	std::string m_message;
+public:
+	BenchmarkReportException(const std::string& message) : m_message(message)
+	{};
+	const char* what() const noexcept override
+	{
+		return m_message.c_str();
+	}
+};
+
+struct FrameStatistics
+{
+	unsigned long long frames = 0;
+	double mean_ms = 0.;
+	double p50_ms = 0.;
+	double p95_ms = 0.;
+	double p99_ms = 0.;
+	double max_ms = 0.;
+};
+
+struct ManagerReport
+{
+	std::string name;
+	double average_ms = 0.;
+};
+
+struct SceneReport
+{
+	std::string name;
+	FrameStatistics frame;
+	std::vector<ManagerReport> managers;
+	unsigned long long entities = 0;
+	unsigned long long peak_rss_kb = 0;
+};
+
+struct BenchmarkReport
+{
+	unsigned long long seed = 0;
+	std::vector<SceneReport> scenes;
+};
+
+// Nearest-rank percentiles over frame_ms after dropping the first warmup frames
+FrameStatistics ComputeFrameStatistics(std::vector<float> frame_ms, size_t warmup);
+SceneReport MakeSceneReport(const std::string& name, const SceneResult& result, size_t warmup);
+
+// Peak resident set size of this process so far
+unsigned long long PeakResidentSetKB();
+
+void WriteSceneReport(std::ostream& out, const SceneReport& scene, int indent = 0);
+void WriteBenchmarkReport(std::ostream& out, const BenchmarkReport& report);
+
+// Reads reports written by the functions above, throws BenchmarkReportException on malformed input
+SceneReport ReadSceneReport(const std::string& path);
+BenchmarkReport ReadBenchmarkReport(const std::string& path);
+
+struct Regression
+{
+	std::string scene;
+	std::string metric;
+	double baseline = 0.;
+	double current = 0.;
+};
+
+// Frame percentiles and peak RSS of every scene present in both reports that grew by more than tolerance (0.1 = 10%)
+std::vector<Regression> CompareReports(const BenchmarkReport& baseline, const BenchmarkReport& current, double tolerance);
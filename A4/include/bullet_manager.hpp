@@ -14,6 +14,8 @@
 #include "collider_manager/collider_manager.hpp"
 
 #include "engine.hpp"
+#include "ecs/components.hpp"
+#include "spawn_log.hpp"
 
 #include <ranges>
 
@@ -32,37 +34,69 @@ struct Bullet
 
 TMesh GetBulletMesh(const Bullet& bullet, int fidelity = 10);
 
+// Spawn request handed from Fire to Update
 struct BulletData
 {
-	unsigned int collider_id;
 	glm::vec2 speed;
 	glm::mat3 transform;
 	float time;
 	float life_time;
 };
+
+struct BulletMotion
+{
+	glm::vec2 speed;
+	float time;
+	float life_time;
+	// Displacement of the last Update, after bounces
+	glm::vec2 step{ 0.f };
+};
 template <typename... Extensions>
 class BulletManager : public IManager
 {
 private:
+	using TColliderManager = typename ColliderManagerOf<Extensions...>::type;
+
 	std::shared_ptr<IGraphicManager> m_graphic_manager;
-	std::shared_ptr<ColliderBBManager> m_collider_manager;
-	std::unordered_map<unsigned int, BulletData> m_bulletsData;
-	unsigned int m_counter = 0;
+	std::shared_ptr<TColliderManager> m_collider_manager;
+	World& m_world;
+	FrameArena& m_frame_arena;
+	JobSystem& m_jobs;
 	float last_time_stamp;
+	float m_max_time_step = 0.1f;
 	unsigned int m_graphic_id;
+	std::shared_ptr<InstanceSnapshotBuffer> m_snapshots = std::make_shared<InstanceSnapshotBuffer>();
+	std::shared_ptr<SpawnRecorder> m_recorder;
+	unsigned int m_contact_subscription;
+
+	struct WallHit
+	{
+		unsigned int collider_id;
+		unsigned int wall_collider_id;
+		glm::vec2 normal;
+	};
+	// Filled by the parallel integration, reported to the collider manager afterwards
+	PerWorker<std::vector<WallHit>> m_hits{ m_jobs };
+
+	static constexpr float s_radius = 0.01f;
+	static constexpr unsigned int s_max_bounces = 4;
+	// Gap left between a bullet and the wall it bounced off, so the discrete test does not see
+	// it touching; scaled by the larger coordinate to stay above float rounding far from the origin
+	static constexpr float s_contact_offset = 1e-5f;
 
 	boost::lockfree::queue<BulletData> bullet_queue{ 1024 };
 
-	void TranslateEntity(BulletData& bullet, const glm::vec2& v_translate)
-	{
-		auto col_transform = glm::translate(glm::mat3(1.f), v_translate);
-		bullet.transform = bullet.transform * col_transform;
-		m_collider_manager->TransformEntity(bullet.collider_id, col_transform);
-	}
 public:
-	BulletManager(const std::tuple<std::shared_ptr<Extensions>...>& extensions, float cur_time) :
+	static constexpr ColliderCategory s_collider_category = 1 << 0;
+
+	using Access = ManagerAccess<Reads<>, Writes<TColliderManager, IGraphicManager, World>>;
+
+	BulletManager(const std::tuple<std::shared_ptr<Extensions>...>& extensions, float cur_time, EngineContext& context) :
 		m_graphic_manager(std::get<std::shared_ptr<IGraphicManager>>(extensions)),
-		m_collider_manager(std::get<std::shared_ptr<ColliderBBManager>>(extensions)),
+		m_collider_manager(std::get<std::shared_ptr<TColliderManager>>(extensions)),
+		m_world(context.world),
+		m_frame_arena(context.frame_arena),
+		m_jobs(context.jobs),
 		last_time_stamp(cur_time)
 	{
 
@@ -71,59 +105,132 @@ public:
 				5.f,
 				glm::vec3{0.8f, 0.f, 0.f}
 			}, 20), "default_instanced_2d"));
+		m_graphic_manager->SetEntityInstanceSnapshots(m_graphic_id, m_snapshots);
 
-		ColliderCircle::OnCollideAll([this](CircleRectCollideInfo info) {
-			m_bulletsData[info.circle_id].speed = glm::reflect(m_bulletsData[info.circle_id].speed, glm::normalize(info.normal_collision));
+		m_contact_subscription = m_collider_manager->Subscribe(s_collider_category, [this](std::span<const CircleRectCollideInfo> contacts) {
+			for (const auto& info : contacts)
+				// A bullet already moving away, e.g. one a cast bounced off this wall, is not turned back into it
+				if (BulletMotion* motion = m_world.TryGet<BulletMotion>(Entity{ info.circle_id }); motion && glm::dot(motion->speed, info.normal_collision) < 0.f)
+					motion->speed = glm::reflect(motion->speed, glm::normalize(info.normal_collision));
 		});
 	};
+	~BulletManager()
+	{
+		m_collider_manager->Unsubscribe(m_contact_subscription);
+	}
 	
 	bool Update(float time) override
 	{
-		float dt = std::min(time - last_time_stamp, 0.01f);
+		float dt = std::min(time - last_time_stamp, m_max_time_step);
 
 		BulletData bullet_data;
 		while (bullet_queue.pop(bullet_data)) {
-			++m_counter;
 			glm::vec2 pos = glm::vec2(bullet_data.transform[2][0], bullet_data.transform[2][1]);
-			bullet_data.collider_id = m_collider_manager->AddEntity(std::make_unique<ColliderCircle>(
-				ColliderCircle({ pos, 0.01f }, m_counter)
-			));
-			m_bulletsData.emplace(m_counter, bullet_data);
+			Entity entity = m_world.Create(
+				BulletMotion{ bullet_data.speed, bullet_data.time, bullet_data.life_time },
+				Transform2D{ bullet_data.transform },
+				ColliderHandle{ 0 });
+			m_world.Get<ColliderHandle>(entity).id = m_collider_manager->AddEntity(
+				ColliderCircle({ pos, s_radius }, entity.value), ColliderMobility::Dynamic, s_collider_category);
 		}
 
-		std::erase_if(m_bulletsData, [this, time](const auto& bulletPair) {
-			const BulletData& bullet = bulletPair.second;
-			if (time - bullet.time > bullet.life_time) {
-				m_collider_manager->DeleteEntity(bullet.collider_id);
-				return true;
+		FrameVector<Entity> expired{ FrameAllocator<Entity>(&m_frame_arena) };
+		m_world.ForEach<BulletMotion, ColliderHandle>([&](Entity entity, const BulletMotion& motion, ColliderHandle collider) {
+			if (time - motion.time > motion.life_time)
+			{
+				m_collider_manager->DeleteEntity(collider.id);
+				expired.push_back(entity);
 			}
-			return false;
+		});
+		for (Entity entity : expired)
+			m_world.Destroy(entity);
+		// Walls added since the last frame must be in the static tree before the casts
+		m_collider_manager->Flush();
+
+		// Bullets are integrated in parallel with continuous collision: a cast stops at the first
+		// wall, the bullet reflects there and goes on with the rest of the step. Casts only read
+		// the collider manager, which is updated afterwards on this thread.
+		m_world.ForEachChunk<BulletMotion, Transform2D, ColliderHandle>([dt, this](size_t count, const Entity*, BulletMotion* motions, Transform2D* transforms, ColliderHandle* colliders) {
+			m_jobs.ParallelForRange(0, count, 256, [=, this](size_t begin, size_t end) {
+				std::vector<WallHit>& hits = m_hits.Local();
+				for (size_t i = begin; i < end; ++i)
+				{
+					glm::vec2 start(transforms[i].matrix[2][0], transforms[i].matrix[2][1]);
+					glm::vec2 pos = start;
+					glm::vec2 remaining = dt * motions[i].speed;
+					// Whatever is left after the last bounce is dropped for this step
+					for (unsigned int bounce = 0; bounce <= s_max_bounces; ++bounce)
+					{
+						std::optional<CircleCastHit> hit = m_collider_manager->CastCircle({ pos, s_radius }, remaining, ~s_collider_category);
+						if (!hit)
+						{
+							pos += remaining;
+							break;
+						}
+						glm::vec2 normal = glm::normalize(hit->normal);
+						pos += hit->time * remaining;
+						pos += s_contact_offset * std::max(1.f, std::max(std::abs(pos.x), std::abs(pos.y))) * normal;
+						remaining = glm::reflect((1.f - hit->time) * remaining, normal);
+						motions[i].speed = glm::reflect(motions[i].speed, normal);
+						hits.push_back({ colliders[i].id, hit->collider_id, hit->normal });
+					}
+					motions[i].step = pos - start;
+					transforms[i].matrix = transforms[i].matrix * glm::translate(glm::mat3(1.f), motions[i].step);
+				}
+				});
+		});
+		m_world.ForEach<BulletMotion, ColliderHandle>([this](Entity, const BulletMotion& motion, ColliderHandle collider) {
+			m_collider_manager->TransformEntity(collider.id, glm::translate(glm::mat3(1.f), motion.step));
 		});
 
-		std::for_each(m_bulletsData.begin(), m_bulletsData.end(), 
-			[dt,time, this](auto& bullet_p) { 
-				TranslateEntity(bullet_p.second, dt * bullet_p.second.speed);
-			}
-		);
+		// Walls learn of cast hits through the contact stream, in bullet order so runs replay the same
+		FrameVector<WallHit> hits{ FrameAllocator<WallHit>(&m_frame_arena) };
+		m_hits.ForEach([&hits](std::vector<WallHit>& local) {
+			hits.insert(hits.end(), local.begin(), local.end());
+			local.clear();
+			});
+		std::stable_sort(hits.begin(), hits.end(), [](const WallHit& a, const WallHit& b) { return a.collider_id < b.collider_id; });
+		for (const auto& hit : hits)
+			m_collider_manager->ReportContact(hit.collider_id, hit.wall_collider_id, hit.normal);
 
 		last_time_stamp = time;
 
-		std::vector<glm::mat3> instanceData;
-		instanceData.reserve(m_bulletsData.size());
-
-		std::ranges::copy(
-			m_bulletsData | std::ranges::views::values
-			| std::views::transform([](const BulletData& wd) { return wd.transform; }),
-			std::back_inserter(instanceData));
-
-		m_graphic_manager->ChangeEntityInstanceTransformation(m_graphic_id, std::make_unique<BufferAdapter<glm::mat3>>(std::move(instanceData)));
+		InstanceSnapshot& snapshot = m_snapshots->Back();
+		snapshot.Clear(time);
+		snapshot.Resize(m_world.Count<BulletMotion, Transform2D>());
+		size_t offset = 0;
+		m_world.ForEachChunk<BulletMotion, Transform2D>([&](size_t count, const Entity* entities, BulletMotion*, Transform2D* transforms) {
+			m_jobs.ParallelForRange(0, count, 1024, [&, offset](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i)
+				{
+					snapshot.ids[offset + i] = entities[i].value;
+					snapshot.transforms[offset + i] = transforms[i].matrix;
+				}
+				});
+			offset += count;
+		});
+		m_snapshots->Publish();
 
 		return true;
 	};
 
+	// Longest step integrated at once, larger frame gaps slow the bullets down; collisions are
+	// continuous, so this only guards against long stalls
+	void SetMaxTimeStep(float max_time_step)
+	{
+		m_max_time_step = max_time_step;
+	}
+
+	void SetSpawnRecorder(std::shared_ptr<SpawnRecorder> recorder)
+	{
+		m_recorder = std::move(recorder);
+	}
+
 	void Fire(glm::vec2 pos, glm::vec2 dir, float speed, float time, float life_time)
 	{
-		while (!bullet_queue.push({ 0, speed * dir, glm::translate(glm::mat3(1.f), pos), time, life_time, }));
+		if (m_recorder)
+			m_recorder->RecordFire({ time, pos, dir, speed, life_time });
+		while (!bullet_queue.push({ speed * dir, glm::translate(glm::mat3(1.f), pos), time, life_time, }));
 	}
 
 
@@ -1,12 +1,14 @@
 #pragma once
 #include <stack>
 #include <vector>
+#include <random>
+#include <algorithm>
 #include "glm/glm.hpp"
 
 const int WIDTH = 75;
 const int HEIGHT = 75;
 
-inline std::vector<std::pair<glm::vec2, glm::vec2>> generateMaze() {
+inline std::vector<std::pair<glm::vec2, glm::vec2>> generateMaze(std::mt19937& gen) {
     std::vector<std::vector<bool>> grid(HEIGHT, std::vector<bool>(WIDTH, true));
     std::vector<std::pair<glm::vec2, glm::vec2>> walls;
 
@@ -15,8 +17,8 @@ inline std::vector<std::pair<glm::vec2, glm::vec2>> generateMaze() {
         };
 
     std::stack<std::pair<int, int>> stack;
-    int startX = (rand() % (WIDTH / 2)) * 2;
-    int startY = (rand() % (HEIGHT / 2)) * 2;
+    int startX = std::uniform_int_distribution<int>(0, WIDTH / 2 - 1)(gen) * 2;
+    int startY = std::uniform_int_distribution<int>(0, HEIGHT / 2 - 1)(gen) * 2;
 
     stack.push({ startX, startY });
     grid[startY][startX] = false;
@@ -26,7 +28,7 @@ inline std::vector<std::pair<glm::vec2, glm::vec2>> generateMaze() {
         stack.pop();
 
         std::vector<std::pair<int, int>> directions = { {0, -2}, {0, 2}, {-2, 0}, {2, 0} };
-        std::shuffle(directions.begin(), directions.end(), std::mt19937{ std::random_device{}() });
+        std::shuffle(directions.begin(), directions.end(), gen);
 
         for (const auto& dir : directions) {
             int nx = x + dir.first, ny = y + dir.second;
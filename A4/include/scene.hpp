@@ -0,0 +1,120 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <string>
+#include <random>
+#include <functional>
+#include <cstdint>
+#include <chrono>
+
+#include "graphic_manager/graphic_manager.hpp"
+#include "engine.hpp"
+#include "spawn_log.hpp"
+
+struct SceneOptions
+{
+	bool headless = false;
+	unsigned long long frames = 0;
+	// Wall-clock limit of the single-loop mode, 0 runs until the scene ends
+	float seconds = 0.f;
+	// 0 keeps simulation and rendering in one Engine::Update loop
+	float simulation_rate = 0.f;
+	float render_rate = 0.f;
+	std::string trace_path;
+	// Drawn from std::random_device unless given
+	std::uint64_t seed = 0;
+	std::string record_path;
+	std::string replay_path;
+	// Replaces the wall clock with a fixed step per frame, defaults to 0.01 s when replaying
+	float fixed_time_step = 0.f;
+	// Runs jobs inline and managers serially
+	bool deterministic = false;
+	// Headless runs print their timings unless quiet
+	bool quiet = false;
+	// ColliderBBManager backend: linear_quadtree, quadtree, spatial_hash or sweep_and_prune
+	std::string broadphase = "linear_quadtree";
+	// Spatial hash cell size, 0 picks the backend default
+	float cell_size = 0.f;
+	// Quadtree child bounds scale, 1 is a plain quadtree
+	float looseness = 1.f;
+};
+
+struct SceneResult
+{
+	// Duration of every Engine::Update; empty in fixed-step thread mode
+	std::vector<float> frame_ms;
+	std::vector<ManagerTiming> timings;
+	size_t entities = 0;
+};
+
+// Recognised arguments: --headless, --frames <count>, --seconds <s>, --simulation-rate <hz>, --render-rate <hz>, --trace <file>,
+// --seed <n>, --record <file>, --replay <file>, --fixed-time-step <seconds>, --deterministic, --broadphase <name>, --cell-size <size>,
+// --looseness <factor>
+SceneOptions ParseSceneOptions(int argc, char** argv);
+
+std::mt19937 CreateGenerator(const SceneOptions& options);
+
+// With --record attaches a recorder to both managers and returns nullptr (the scene spawns as usual).
+// With --replay adds the recorded walls and returns the replay the scene must pump instead of spawning.
+template <typename TBulletManager, typename TWallManager>
+std::shared_ptr<SpawnReplay> SetupSpawnLog(const SceneOptions& options, TBulletManager& bullet_manager, TWallManager& wall_manager)
+{
+	if (!options.record_path.empty())
+	{
+		auto recorder = std::make_shared<SpawnRecorder>(options.record_path, options.seed);
+		bullet_manager.SetSpawnRecorder(recorder);
+		wall_manager.SetSpawnRecorder(recorder);
+	}
+	if (options.replay_path.empty())
+		return nullptr;
+	auto replay = std::make_shared<SpawnReplay>(options.replay_path);
+	replay->AddWalls(wall_manager);
+	return replay;
+}
+
+// GLGraphicManager with the default instanced program, or NullGraphicManager when headless
+std::shared_ptr<IGraphicManager> CreateGraphicManager(const SceneOptions& options);
+
+void PrintTimings(const std::vector<ManagerTiming>& timings);
+void StartTrace(const SceneOptions& options);
+void FinishTrace(const SceneOptions& options);
+
+// before_update is called with the frame time ahead of every Engine::Update (not in fixed-step thread mode)
+template <typename TEngine>
+SceneResult RunScene(TEngine& engine, const SceneOptions& options, std::function<void(float)> before_update = {})
+{
+	SceneResult result;
+	if (options.deterministic)
+	{
+		engine.GetContext().jobs.SetDeterministic(true);
+		engine.SetSchedulingMode(SchedulingMode::Serial);
+	}
+	StartTrace(options);
+	if (options.simulation_rate > 0.f && !before_update)
+		engine.Run(FixedStepConfig{ options.simulation_rate, options.render_rate });
+	else
+	{
+		using clock = std::chrono::steady_clock;
+		auto start = clock::now();
+		bool running = true;
+		while (running)
+		{
+			if (before_update)
+				before_update(engine.GetCurrentTimeStamp());
+			auto frame_start = clock::now();
+			running = engine.Update();
+			auto frame_end = clock::now();
+			result.frame_ms.push_back(std::chrono::duration<float, std::milli>(frame_end - frame_start).count());
+			if (options.seconds > 0.f && std::chrono::duration<float>(frame_end - start).count() >= options.seconds)
+				running = false;
+		}
+		engine.Stop();
+	}
+	FinishTrace(options);
+
+	result.timings = engine.GetTimings();
+	result.entities = engine.GetContext().world.Size();
+	if (options.headless && !options.quiet)
+		PrintTimings(result.timings);
+	return result;
+}
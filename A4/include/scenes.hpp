@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "scene.hpp"
+
+// 10k random walls hit by 1k bullets fired from the centre
+SceneResult RunPerformanceStressTesting1(const SceneOptions& options);
+// 100k random walls hit by 10k bullets fired from the centre
+SceneResult RunPerformanceStressTesting2(const SceneOptions& options);
+// A maze with bullets fired from another thread every few seconds
+SceneResult RunMTStabilityStressTesting(const SceneOptions& options);
+
+struct SceneEntry
+{
+	std::string name;
+	SceneResult(*run)(const SceneOptions&);
+};
+
+// Every stress scene under its executable name
+const std::vector<SceneEntry>& GetScenes();
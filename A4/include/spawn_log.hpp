@@ -0,0 +1,99 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include <exception>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+class SpawnLogException : public std::exception
+{
+	std::string m_message;
+public:
+	SpawnLogException(const std::string& message) : m_message(message)
+	{};
+	const char* what() const noexcept override
+	{
+		return m_message.c_str();
+	}
+};
+
+struct WallSpawn
+{
+	glm::vec2 start;
+	glm::vec2 end;
+	float thickness;
+};
+
+struct FireSpawn
+{
+	float time;
+	glm::vec2 pos;
+	glm::vec2 dir;
+	float speed;
+	float life_time;
+};
+
+// Binary spawn log: "A4SL", u32 version, u64 seed, then records tagged by one byte
+// (1 = wall, 2 = fire) with float fields in host byte order.
+class SpawnRecorder
+{
+private:
+	std::ofstream m_out;
+	std::mutex m_mutex;
+
+	template <typename T>
+	void Write(const T& value)
+	{
+		m_out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+public:
+	SpawnRecorder(const std::string& path, std::uint64_t seed);
+
+	void RecordWall(const WallSpawn& wall);
+	// Safe to call from any thread
+	void RecordFire(const FireSpawn& fire);
+};
+
+class SpawnReplay
+{
+private:
+	std::uint64_t m_seed = 0;
+	std::vector<WallSpawn> m_walls;
+	std::vector<FireSpawn> m_fires;
+	size_t m_next_fire = 0;
+public:
+	SpawnReplay(const std::string& path);
+
+	std::uint64_t Seed() const noexcept
+	{
+		return m_seed;
+	}
+	const std::vector<WallSpawn>& Walls() const noexcept
+	{
+		return m_walls;
+	}
+	bool Finished() const noexcept
+	{
+		return m_next_fire == m_fires.size();
+	}
+
+	template <typename TWallManager>
+	void AddWalls(TWallManager& wall_manager) const
+	{
+		wall_manager.AddWalls(m_walls);
+	}
+
+	// Fires every recorded bullet whose timestamp has been reached
+	template <typename TBulletManager>
+	void Pump(TBulletManager& bullet_manager, float time)
+	{
+		for (; m_next_fire < m_fires.size() && m_fires[m_next_fire].time <= time; ++m_next_fire)
+		{
+			const FireSpawn& fire = m_fires[m_next_fire];
+			bullet_manager.Fire(fire.pos, fire.dir, fire.speed, fire.time, fire.life_time);
+		}
+	}
+};
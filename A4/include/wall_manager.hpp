@@ -8,6 +8,8 @@
 #include "collider_manager/collider_manager.hpp"
 
 #include "engine.hpp"
+#include "ecs/components.hpp"
+#include "spawn_log.hpp"
 
 #include "ranges"
 
@@ -24,26 +26,32 @@ struct Wall
 TMesh GetWallMesh(const Wall& wall);
 glm::mat3 SegmentTransformWithThickness(const glm::vec2& A, const glm::vec2& B,
 	const glm::vec2& C, const glm::vec2& D, float thicknessAB = 0.1f, float thicknessCD = 0.1f);
-struct WallData
-{
-	unsigned int collider_id;
-	glm::mat3 transform;
-};
+struct WallTag
+{};
 
 template <typename... Extensions>
 class WallManager final : public IManager
 {
 private:
+	using TColliderManager = typename ColliderManagerOf<Extensions...>::type;
+
 	std::shared_ptr<IGraphicManager> m_graphic_manager;
-	std::shared_ptr<ColliderBBManager> m_collider_manager;
-	std::unordered_map<unsigned int, WallData> m_wallsData;
+	std::shared_ptr<TColliderManager> m_collider_manager;
+	World& m_world;
 	unsigned int m_graphic_id;
-	std::vector<WallData> m_exposedWallsData;
-	unsigned int m_counter = 0;
+	// Colliders of walls destroyed by a hit, deleted on the next Update (not from inside the collider's own Update)
+	std::vector<unsigned int> m_exposedColliders;
+	std::shared_ptr<SpawnRecorder> m_recorder;
+	unsigned int m_contact_subscription;
 public:
-	WallManager(const std::tuple<std::shared_ptr<Extensions>...>& extensions, float) :
+	static constexpr ColliderCategory s_collider_category = 1 << 1;
+
+	using Access = ManagerAccess<Reads<>, Writes<TColliderManager, IGraphicManager, World>>;
+
+	WallManager(const std::tuple<std::shared_ptr<Extensions>...>& extensions, float, EngineContext& context) :
 		m_graphic_manager(std::get<std::shared_ptr<IGraphicManager>>(extensions)),
-		m_collider_manager(std::get<std::shared_ptr<ColliderBBManager>>(extensions))
+		m_collider_manager(std::get<std::shared_ptr<TColliderManager>>(extensions)),
+		m_world(context.world)
 	{
 		m_graphic_id = m_graphic_manager->AddEntityInstanced(std::make_unique<GraphicEntityInstanced<glm::vec2, unsigned int, glm::mat3, glm::vec3>>(
 			GetWallMesh({
@@ -53,46 +61,85 @@ public:
 				glm::vec3{0.5f, 0.5f, 0.f}
 				}), "default_instanced_2d"));
 
-		ColliderCircle::OnCollideAll([this](CircleRectCollideInfo info) {
-			auto it = m_wallsData.find(info.rect_id);
-			if (it != m_wallsData.end())
+		m_contact_subscription = m_collider_manager->Subscribe(s_collider_category, [this](std::span<const CircleRectCollideInfo> contacts) {
+			for (const auto& info : contacts)
 			{
-				m_exposedWallsData.push_back(it->second);
-				m_wallsData.erase(it);
+				Entity entity{ info.rect_id };
+				if (m_world.IsAlive(entity) && m_world.Has<WallTag>(entity))
+				{
+					m_exposedColliders.push_back(m_world.Get<ColliderHandle>(entity).id);
+					m_world.Destroy(entity);
+				}
 			}
 		});
 	};
+	~WallManager()
+	{
+		m_collider_manager->Unsubscribe(m_contact_subscription);
+	}
+
+	void SetSpawnRecorder(std::shared_ptr<SpawnRecorder> recorder)
+	{
+		m_recorder = std::move(recorder);
+	}
 
 	void AddWall(glm::vec2 start, glm::vec2 end, float thickness = 0.01f)
 	{
-		++m_counter;
-		
-		unsigned int cid = m_collider_manager->AddEntity(std::make_unique<ColliderRect>(
-			ColliderRect(Rect{ start,end,thickness }, m_counter)));
+		if (m_recorder)
+			m_recorder->RecordWall({ start, end, thickness });
+
+		Entity entity = m_world.Create(
+			WallTag{},
+			Transform2D{ ::SegmentTransformWithThickness({0.f, 0.f}, {1.f, 0.f}, start, end, 0.01f, thickness) },
+			ColliderHandle{ 0 });
+		m_world.Get<ColliderHandle>(entity).id = m_collider_manager->AddEntity(
+			ColliderRect(Rect{ start,end,thickness }, entity.value), ColliderMobility::Static, s_collider_category);
+	}
 
-		m_wallsData.emplace(m_counter, WallData{ cid,  ::SegmentTransformWithThickness({0.f, 0.f}, {1.f, 0.f}, start, end, 0.01f, thickness)});
+	// AddWall for every wall, with one bulk add to the collider manager
+	void AddWalls(std::span<const WallSpawn> walls)
+	{
+		std::vector<Entity> entities;
+		std::vector<ColliderRect> colliders;
+		entities.reserve(walls.size());
+		colliders.reserve(walls.size());
+		for (const auto& wall : walls)
+		{
+			if (m_recorder)
+				m_recorder->RecordWall(wall);
+
+			Entity entity = m_world.Create(
+				WallTag{},
+				Transform2D{ ::SegmentTransformWithThickness({0.f, 0.f}, {1.f, 0.f}, wall.start, wall.end, 0.01f, wall.thickness) },
+				ColliderHandle{ 0 });
+			entities.push_back(entity);
+			colliders.emplace_back(Rect{ wall.start, wall.end, wall.thickness }, entity.value);
+		}
+		std::vector<unsigned int> ids = m_collider_manager->AddEntities(colliders, ColliderMobility::Static, s_collider_category);
+		for (size_t i = 0; i < entities.size(); ++i)
+			m_world.Get<ColliderHandle>(entities[i]).id = ids[i];
 	}
 
 	bool Update(float) override
 	{
 		
-		std::for_each(m_exposedWallsData.begin(), m_exposedWallsData.end(), [&](auto& wallData) {
-			m_collider_manager->DeleteEntity(wallData.collider_id);
+		std::for_each(m_exposedColliders.begin(), m_exposedColliders.end(), [&](unsigned int collider_id) {
+			m_collider_manager->DeleteEntity(collider_id);
 			});
 
-		if (!m_exposedWallsData.empty())
+		if (!m_exposedColliders.empty())
 		{
 			std::vector<glm::mat3> instanceData;
-			instanceData.reserve(m_wallsData.size());
+			instanceData.reserve(m_world.Count<WallTag>());
 
-			std::ranges::copy(
-				m_wallsData | std::ranges::views::values
-				| std::views::transform([](const WallData& wd) { return wd.transform; }),
-				std::back_inserter(instanceData));
+			m_world.ForEachChunk<WallTag, Transform2D>([&](size_t count, const Entity*, WallTag*, Transform2D* transforms) {
+				std::transform(transforms, transforms + count, std::back_inserter(instanceData),
+					[](const Transform2D& transform) { return transform.matrix; });
+				});
 
 			m_graphic_manager->ChangeEntityInstanceTransformation(m_graphic_id, std::make_unique<BufferAdapter<glm::mat3>>(std::move(instanceData)));
 
-			m_exposedWallsData.clear();
+			m_exposedColliders.clear();
 		}
 		
 		return true;
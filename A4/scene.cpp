@@ -0,0 +1,104 @@
+#include "scene.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+
+#include "graphic_manager/graphic_shader.hpp"
+#include "graphic_manager/null_graphic_manager.hpp"
+#include "profiler/profiler.hpp"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/matrix_transform_2d.hpp>
+
+SceneOptions ParseSceneOptions(int argc, char** argv)
+{
+	SceneOptions options;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--headless")
+			options.headless = true;
+		else if (arg == "--frames" && i + 1 < argc)
+			options.frames = std::stoull(argv[++i]);
+		else if (arg == "--seconds" && i + 1 < argc)
+			options.seconds = std::stof(argv[++i]);
+		else if (arg == "--simulation-rate" && i + 1 < argc)
+			options.simulation_rate = std::stof(argv[++i]);
+		else if (arg == "--render-rate" && i + 1 < argc)
+			options.render_rate = std::stof(argv[++i]);
+		else if (arg == "--trace" && i + 1 < argc)
+			options.trace_path = argv[++i];
+		else if (arg == "--seed" && i + 1 < argc)
+			options.seed = std::stoull(argv[++i]);
+		else if (arg == "--record" && i + 1 < argc)
+			options.record_path = argv[++i];
+		else if (arg == "--replay" && i + 1 < argc)
+			options.replay_path = argv[++i];
+		else if (arg == "--fixed-time-step" && i + 1 < argc)
+			options.fixed_time_step = std::stof(argv[++i]);
+		else if (arg == "--deterministic")
+			options.deterministic = true;
+		else if (arg == "--broadphase" && i + 1 < argc)
+			options.broadphase = argv[++i];
+		else if (arg == "--cell-size" && i + 1 < argc)
+			options.cell_size = std::stof(argv[++i]);
+		else if (arg == "--looseness" && i + 1 < argc)
+			options.looseness = std::stof(argv[++i]);
+	}
+	if (std::none_of(argv + 1, argv + argc, [](const char* arg) { return std::string(arg) == "--seed"; }))
+		options.seed = std::random_device{}();
+	if (!options.replay_path.empty() && options.fixed_time_step == 0.f)
+		options.fixed_time_step = 0.01f;
+	return options;
+}
+
+std::mt19937 CreateGenerator(const SceneOptions& options)
+{
+	return std::mt19937(static_cast<std::mt19937::result_type>(options.seed));
+}
+
+std::shared_ptr<IGraphicManager> CreateGraphicManager(const SceneOptions& options)
+{
+	if (options.headless)
+		return std::make_shared<NullGraphicManager>(options.frames);
+
+	std::shared_ptr<GLGraphicManager> graphic_manager = std::make_shared<GLGraphicManager>();
+	graphic_manager->SetModelTransformation(glm::scale(glm::mat3(1.f), glm::vec2(1e-3f)));
+	std::unique_ptr<IProgram> program = std::make_unique<GLProgram>(
+		GLProgramBuilder()
+		.AddShader(ShaderType::Vertex, shaders_source::vertex_shader_instanced_default_2d)
+		.AddShader(ShaderType::Fragment, shaders_source::fragment_shader_default_2d)
+		.Build()
+	);
+
+	graphic_manager->AddProgram(std::move(program), "default_instanced_2d");
+	return graphic_manager;
+}
+
+void PrintTimings(const std::vector<ManagerTiming>& timings)
+{
+	for (const auto& timing : timings)
+		std::cout << std::fixed << std::setprecision(3) << std::setw(10) << timing.average_ms << " ms  " << timing.name << '\n';
+}
+
+
+void StartTrace(const SceneOptions& options)
+{
+	if (options.trace_path.empty())
+		return;
+#ifndef ENGINE_PROFILING
+	std::cerr << "--trace: Engine was built without ENGINE_PROFILING, the trace will be empty\n";
+#endif
+	Profiler::Get().Start();
+}
+
+void FinishTrace(const SceneOptions& options)
+{
+	if (options.trace_path.empty())
+		return;
+	Profiler::Get().Stop();
+	if (!Profiler::Get().WriteChromeTrace(options.trace_path))
+		std::cerr << "--trace: cannot write " << options.trace_path << '\n';
+}
@@ -0,0 +1,178 @@
+#include "scenes.hpp"
+
+#include <memory>
+#include <ranges>
+#include <random>
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include <type_traits>
+
+#include "engine.hpp"
+#include "bullet_manager.hpp"
+#include "wall_manager.hpp"
+#include "generators.hpp"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/matrix_transform_2d.hpp>
+
+namespace
+{
+	constexpr float s_world_scale = 1e+3f;
+
+	template <typename TBroadphase>
+	std::shared_ptr<BasicColliderBBManager<TBroadphase>> CreateColliderManager(const SceneOptions& options)
+	{
+		if constexpr (std::is_same_v<TBroadphase, SpatialHash>)
+			return std::make_shared<BasicColliderBBManager<TBroadphase>>(SpatialHash(glm::vec2(-s_world_scale), 2.f * s_world_scale, options.cell_size));
+		else if constexpr (std::is_same_v<TBroadphase, Quadtree>)
+			return std::make_shared<BasicColliderBBManager<TBroadphase>>(Quadtree(glm::vec2(-s_world_scale), 2.f * s_world_scale, options.looseness));
+		else
+			return std::make_shared<BasicColliderBBManager<TBroadphase>>(s_world_scale);
+	}
+
+	// Items per depth of the dynamic broadphase at the end of a headless run, for tree backends
+	template <typename TBroadphase>
+	void PrintBroadphaseLevels(const SceneOptions& options, const TBroadphase& broadphase)
+	{
+		if constexpr (requires { broadphase.ItemsPerLevel(); })
+		{
+			if (!options.headless || options.quiet)
+				return;
+			auto items_per_level = broadphase.ItemsPerLevel();
+			for (size_t level = 0; level < items_per_level.size(); ++level)
+				std::cout << "level " << level << ": " << items_per_level[level] << " items\n";
+		}
+	}
+
+	// Calls run with std::type_identity of the broadphase named in the options
+	template <typename Run>
+	SceneResult WithBroadphase(const SceneOptions& options, Run run)
+	{
+		if (options.broadphase == "quadtree")
+			return run(std::type_identity<Quadtree>{});
+		if (options.broadphase == "spatial_hash")
+			return run(std::type_identity<SpatialHash>{});
+		if (options.broadphase == "sweep_and_prune")
+			return run(std::type_identity<SweepAndPrune>{});
+		if (options.broadphase != "linear_quadtree")
+			std::cerr << "--broadphase: unknown broadphase " << options.broadphase << ", using linear_quadtree\n";
+		return run(std::type_identity<LinearQuadtree>{});
+	}
+
+	template <typename TBroadphase>
+	SceneResult RunPerformanceScene(const SceneOptions& options, int wall_count, int bullet_count)
+	{
+		using TColliderManager = BasicColliderBBManager<TBroadphase>;
+		std::shared_ptr<IGraphicManager> graphic_manager = CreateGraphicManager(options);
+		std::shared_ptr<TColliderManager> collider_manager = CreateColliderManager<TBroadphase>(options);
+
+		using Bullets = BulletManager<TColliderManager, IGraphicManager>;
+		using Walls = WallManager<TColliderManager, IGraphicManager>;
+
+		StaticEngine<ManagerList<Bullets, Walls>, TColliderManager, IGraphicManager> engine(
+			std::make_tuple(collider_manager, graphic_manager), options.fixed_time_step);
+
+		auto& bulletManager = engine.template GetManager<Bullets>();
+		auto& wallManager = engine.template GetManager<Walls>();
+
+		std::shared_ptr<SpawnReplay> replay = SetupSpawnLog(options, bulletManager, wallManager);
+		if (replay)
+			return RunScene(engine, options, [&](float time) { replay->Pump(bulletManager, time); });
+
+		std::mt19937 gen = CreateGenerator(options);
+		std::uniform_real_distribution<float> distr_float(-950.f, 950.f);
+		std::uniform_real_distribution<float> distr_float_offset(10.f, 100.f);
+
+		std::vector<WallSpawn> walls;
+		walls.reserve(wall_count);
+		std::ranges::for_each(std::views::iota(0, wall_count), [&](auto) {
+			glm::vec2 vec = glm::vec2(distr_float(gen), distr_float(gen));
+			walls.push_back({ vec, glm::vec2(std::min(vec.x + distr_float_offset(gen), 950.f), std::min(vec.y + distr_float_offset(gen), 950.f)), 5 });
+			});
+		wallManager.AddWalls(walls);
+
+		std::ranges::for_each(std::views::iota(0, bullet_count), [&](auto) {
+			bulletManager.Fire(glm::vec2{ 0.f, 0.f }, glm::normalize(glm::vec2(distr_float(gen), distr_float(gen))), 800.f, engine.GetCurrentTimeStamp(), 60);
+			});
+
+		SceneResult result = RunScene(engine, options);
+		PrintBroadphaseLevels(options, collider_manager->GetBroadphase());
+		return result;
+	}
+
+	template <typename TBroadphase>
+	SceneResult RunMTStabilityScene(const SceneOptions& options)
+	{
+		using TColliderManager = BasicColliderBBManager<TBroadphase>;
+		std::shared_ptr<IGraphicManager> graphic_manager = CreateGraphicManager(options);
+		std::shared_ptr<TColliderManager> collider_manager = CreateColliderManager<TBroadphase>(options);
+
+		Engine<TColliderManager, IGraphicManager> engine(std::make_tuple(collider_manager, graphic_manager));
+		engine.SetFixedTimeStep(options.fixed_time_step);
+		auto bulletManager = engine.template AddManager<BulletManager<TColliderManager, IGraphicManager>>();
+		auto wallManager = engine.template AddManager<WallManager<TColliderManager, IGraphicManager>>();
+
+		std::shared_ptr<SpawnReplay> replay = SetupSpawnLog(options, *bulletManager, *wallManager);
+		if (replay)
+			return RunScene(engine, options, [&](float time) { replay->Pump(*bulletManager, time); });
+
+		std::mt19937 gen = CreateGenerator(options);
+		std::vector<WallSpawn> walls;
+		std::ranges::for_each(generateMaze(gen), [&](auto& pair) {
+			walls.push_back({ pair.first, pair.second, 8 });
+			});
+		wallManager->AddWalls(walls);
+
+		std::thread thread([&]() {
+			std::uniform_real_distribution<> distr_float(-1, 1);
+			while (engine.IsActive())
+			{
+				std::ranges::for_each(std::views::iota(0, 20), [&](auto) {
+					bulletManager->Fire(glm::vec2{ 0.f, 0.f }, glm::normalize(glm::vec2(distr_float(gen), distr_float(gen))), 800.f, engine.GetCurrentTimeStamp(), 8);
+					});
+				// Sleeps in slices so the thread notices a stopped engine quickly
+				for (int i = 0; i < 40 && engine.IsActive(); ++i)
+					std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			}
+			});
+
+		SceneResult result = RunScene(engine, options);
+
+		thread.join();
+		PrintBroadphaseLevels(options, collider_manager->GetBroadphase());
+
+		return result;
+	}
+}
+
+SceneResult RunPerformanceStressTesting1(const SceneOptions& options)
+{
+	return WithBroadphase(options, [&]<typename TBroadphase>(std::type_identity<TBroadphase>) {
+		return RunPerformanceScene<TBroadphase>(options, 10000, 1000);
+		});
+}
+
+SceneResult RunPerformanceStressTesting2(const SceneOptions& options)
+{
+	return WithBroadphase(options, [&]<typename TBroadphase>(std::type_identity<TBroadphase>) {
+		return RunPerformanceScene<TBroadphase>(options, 100000, 10000);
+		});
+}
+
+SceneResult RunMTStabilityStressTesting(const SceneOptions& options)
+{
+	return WithBroadphase(options, [&]<typename TBroadphase>(std::type_identity<TBroadphase>) {
+		return RunMTStabilityScene<TBroadphase>(options);
+		});
+}
+
+const std::vector<SceneEntry>& GetScenes()
+{
+	static const std::vector<SceneEntry> s_scenes = {
+		{ "performance_stress_testing_1", &RunPerformanceStressTesting1 },
+		{ "performance_stress_testing_2", &RunPerformanceStressTesting2 },
+		{ "mt_stability_stress_testing", &RunMTStabilityStressTesting },
+	};
+	return s_scenes;
+}
@@ -0,0 +1,86 @@
+#include "spawn_log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace
+{
+	constexpr std::array<char, 4> s_magic = { 'A', '4', 'S', 'L' };
+	constexpr std::uint32_t s_version = 1;
+	enum class Record : std::uint8_t
+	{
+		Wall = 1,
+		Fire = 2
+	};
+
+	template <typename T>
+	bool Read(std::ifstream& in, T& value)
+	{
+		return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+}
+
+SpawnRecorder::SpawnRecorder(const std::string& path, std::uint64_t seed) : m_out(path, std::ios::binary)
+{
+	if (!m_out)
+		throw SpawnLogException("cannot open spawn log for writing: " + path);
+	m_out.write(s_magic.data(), s_magic.size());
+	Write(s_version);
+	Write(seed);
+}
+
+void SpawnRecorder::RecordWall(const WallSpawn& wall)
+{
+	std::lock_guard lock(m_mutex);
+	Write(Record::Wall);
+	Write(wall.start.x); Write(wall.start.y);
+	Write(wall.end.x); Write(wall.end.y);
+	Write(wall.thickness);
+}
+
+void SpawnRecorder::RecordFire(const FireSpawn& fire)
+{
+	std::lock_guard lock(m_mutex);
+	Write(Record::Fire);
+	Write(fire.time);
+	Write(fire.pos.x); Write(fire.pos.y);
+	Write(fire.dir.x); Write(fire.dir.y);
+	Write(fire.speed);
+	Write(fire.life_time);
+}
+
+SpawnReplay::SpawnReplay(const std::string& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	std::array<char, 4> magic;
+	std::uint32_t version = 0;
+	if (!in || !in.read(magic.data(), magic.size()) || magic != s_magic)
+		throw SpawnLogException("not a spawn log: " + path);
+	if (!Read(in, version) || version != s_version || !Read(in, m_seed))
+		throw SpawnLogException("unsupported spawn log version: " + path);
+
+	Record record;
+	while (Read(in, record))
+	{
+		bool ok = false;
+		if (record == Record::Wall)
+		{
+			WallSpawn wall;
+			ok = Read(in, wall.start.x) && Read(in, wall.start.y) && Read(in, wall.end.x) && Read(in, wall.end.y)
+				&& Read(in, wall.thickness);
+			m_walls.push_back(wall);
+		}
+		else if (record == Record::Fire)
+		{
+			FireSpawn fire;
+			ok = Read(in, fire.time) && Read(in, fire.pos.x) && Read(in, fire.pos.y) && Read(in, fire.dir.x)
+				&& Read(in, fire.dir.y) && Read(in, fire.speed) && Read(in, fire.life_time);
+			m_fires.push_back(fire);
+		}
+		if (!ok)
+			throw SpawnLogException("corrupted spawn log: " + path);
+	}
+	// Fires recorded from several threads may be slightly out of order
+	std::stable_sort(m_fires.begin(), m_fires.end(), [](const FireSpawn& a, const FireSpawn& b) { return a.time < b.time; });
+}
@@ -1,8 +1,7 @@
 #include "collider_manager/collider_handlers.hpp"
 #include <optional>
 #include <algorithm>
-
-std::vector<std::function<void(CircleRectCollideInfo)>> ColliderCircle::s_callbacks_circle_rect_collider;
+#include <cmath>
 
 std::optional<glm::vec2> GetNormalCollision(const Rect& r, const Circle& c)
 {
@@ -16,17 +15,91 @@ std::optional<glm::vec2> GetNormalCollision(const Rect& r, const Circle& c)
 	return {};
 }
 
+std::optional<SweepHit> SweepCircleRect(const Circle& circle, glm::vec2 motion, const Rect& rect)
+{
+	if (GetNormalCollision(rect, circle).has_value())
+		return {};
+	float reach = circle.radius + rect.height;
+	std::optional<SweepHit> hit;
+	auto keep = [&hit](float time, glm::vec2 normal) {
+		if (time >= 0.f && time <= 1.f && (!hit || time < hit->time))
+			hit = SweepHit{ time, normal };
+		};
+
+	// The capsule is the band along the axis plus a disc at each end, the first contact is the
+	// earliest entry into any of them
+	glm::vec2 rect_axis = rect.end - rect.start;
+	float axis_length2 = glm::dot(rect_axis, rect_axis);
+	if (axis_length2 > 0.f)
+	{
+		glm::vec2 side = glm::normalize(glm::vec2(-rect_axis.y, rect_axis.x));
+		float distance = glm::dot(circle.pos - rect.start, side);
+		float approach = glm::dot(motion, side);
+		float sign = distance > 0.f ? 1.f : -1.f;
+		if (approach * sign < 0.f)
+		{
+			float time = (sign * reach - distance) / approach;
+			float along = glm::dot(circle.pos + time * motion - rect.start, rect_axis) / axis_length2;
+			if (along >= 0.f && along <= 1.f)
+				keep(time, sign * reach * side);
+		}
+	}
+	float motion_length2 = glm::dot(motion, motion);
+	if (motion_length2 > 0.f)
+		for (glm::vec2 end : { rect.start, rect.end })
+		{
+			glm::vec2 offset = circle.pos - end;
+			float b = glm::dot(offset, motion);
+			float discriminant = b * b - motion_length2 * (glm::dot(offset, offset) - reach * reach);
+			if (b < 0.f && discriminant >= 0.f)
+			{
+				float time = (-b - std::sqrt(discriminant)) / motion_length2;
+				keep(time, offset + time * motion);
+			}
+		}
+	return hit;
+}
+
+std::optional<SweepHit> SweepCircleCircle(const Circle& circle, glm::vec2 motion, const Circle& target)
+{
+	float reach = circle.radius + target.radius;
+	glm::vec2 offset = circle.pos - target.pos;
+	float c = glm::dot(offset, offset) - reach * reach;
+	float b = glm::dot(offset, motion);
+	float motion_length2 = glm::dot(motion, motion);
+	if (c < 0.f || b >= 0.f || motion_length2 == 0.f)
+		return {};
+	float discriminant = b * b - motion_length2 * c;
+	if (discriminant < 0.f)
+		return {};
+	float time = (-b - std::sqrt(discriminant)) / motion_length2;
+	if (time > 1.f)
+		return {};
+	return SweepHit{ time, offset + time * motion };
+}
+
+float Distance(glm::vec2 point, const Rect& rect)
+{
+	glm::vec2 rect_axis = rect.end - rect.start;
+	float axis_length2 = glm::dot(rect_axis, rect_axis);
+	float t = axis_length2 > 0.f ? std::clamp(glm::dot(rect_axis, point - rect.start) / axis_length2, 0.f, 1.f) : 0.f;
+	return std::max(glm::length(point - (rect.start + t * rect_axis)) - rect.height, 0.f);
+}
 
-void ColliderCircle::Test(const ColliderRect* collider) const
+float Distance(glm::vec2 point, const Circle& circle)
+{
+	return std::max(glm::length(point - circle.pos) - circle.radius, 0.f);
+}
+
+std::optional<CircleRectCollideInfo> ColliderCircle::Test(const ColliderRect* collider) const
 {
 	std::optional<glm::vec2> n = GetNormalCollision(collider->m_rect, m_circle);
 	if (n.has_value())
-		std::for_each(s_callbacks_circle_rect_collider.begin(), s_callbacks_circle_rect_collider.end(), [n, this, collider](auto& callback) {
-		callback({ n.value(), this->GetId(), collider->GetId() });
-			});
+		return CircleRectCollideInfo{ n.value(), GetId(), collider->GetId() };
+	return {};
 }
 
-void ColliderRect::Test(const ColliderCircle* collider) const
+std::optional<CircleRectCollideInfo> ColliderRect::Test(const ColliderCircle* collider) const
 {
-	collider->Test(this);
+	return collider->Test(this);
 }
\ No newline at end of file
@@ -1,46 +1,501 @@
 #include "collider_manager/collider_manager.hpp"
 
+#include <algorithm>
+#include <limits>
 
-unsigned int ColliderBBManager::AddEntity(std::unique_ptr<IColliderAABB> collider)
+
+template <Broadphase TBroadphase>
+const std::array<std::array<typename BasicColliderBBManager<TBroadphase>::PairCollector, BasicColliderBBManager<TBroadphase>::s_shape_count>, BasicColliderBBManager<TBroadphase>::s_shape_count>
+	BasicColliderBBManager<TBroadphase>::s_pair_collectors = { {
+		// Circle with circle, rect
+		{ nullptr, &CollectCircleRect },
+		// Rect with circle, rect
+		{ &CollectRectCircle, nullptr },
+	} };
+
+template <Broadphase TBroadphase>
+void BasicColliderBBManager<TBroadphase>::CollectCircleRect(const BasicColliderBBManager& manager, unsigned int circle_id, unsigned int rect_id, CircleRectBatch& batch)
+{
+	const ColliderCircle& circle = manager.m_circles[manager.m_slots[circle_id].index];
+	const ColliderRect& rect = manager.m_rects[manager.m_slots[rect_id].index];
+	batch.Add(circle.GetCircle(), circle.GetId(), rect.GetRect(), rect.GetId(), manager.m_category[circle_id] | manager.m_category[rect_id]);
+}
+
+template <Broadphase TBroadphase>
+template <typename TCollider>
+unsigned int BasicColliderBBManager<TBroadphase>::Add(ColliderPool<TCollider>& pool, ColliderShape shape, const TCollider& collider,
+	ColliderMobility mobility, ColliderCategory category)
+{
+	unsigned int collider_id;
+	if (!m_free_ids.empty())
+	{
+		collider_id = m_free_ids.back();
+		m_free_ids.pop_back();
+	}
+	else
+	{
+		collider_id = static_cast<unsigned int>(m_slots.size());
+		m_slots.emplace_back();
+		m_mobility.emplace_back();
+		m_category.emplace_back();
+		m_pending_move_of.push_back(s_no_slot);
+	}
+	std::uint32_t index = pool.Add(collider_id, collider);
+	m_slots[collider_id] = { shape, index };
+	m_mobility[collider_id] = mobility;
+	m_category[collider_id] = category;
+	if (mobility == ColliderMobility::Static)
+	{
+		++m_static_count;
+		m_static_tree_dirty = true;
+	}
+	else
+	{
+		m_broadphase.Insert(collider_id, pool[index].GetBoundingBox());
+		m_dynamic_categories |= category;
+	}
+	return collider_id;
+}
+
+template <Broadphase TBroadphase>
+unsigned int BasicColliderBBManager<TBroadphase>::AddEntity(const ColliderCircle& collider, ColliderMobility mobility, ColliderCategory category)
+{
+	return Add(m_circles, ColliderShape::Circle, collider, mobility, category);
+}
+
+template <Broadphase TBroadphase>
+unsigned int BasicColliderBBManager<TBroadphase>::AddEntity(const ColliderRect& collider, ColliderMobility mobility, ColliderCategory category)
+{
+	return Add(m_rects, ColliderShape::Rect, collider, mobility, category);
+}
+
+template <Broadphase TBroadphase>
+unsigned int BasicColliderBBManager<TBroadphase>::AddEntity(std::unique_ptr<IColliderAABB> collider, ColliderMobility mobility, ColliderCategory category)
+{
+	switch (collider->GetShape())
+	{
+	case ColliderShape::Circle:
+		return AddEntity(static_cast<const ColliderCircle&>(*collider), mobility, category);
+	default:
+		return AddEntity(static_cast<const ColliderRect&>(*collider), mobility, category);
+	}
+}
+
+template <Broadphase TBroadphase>
+template <typename TCollider>
+std::vector<unsigned int> BasicColliderBBManager<TBroadphase>::AddMany(ColliderPool<TCollider>& pool, ColliderShape shape, std::span<const TCollider> colliders,
+	ColliderMobility mobility, ColliderCategory category)
+{
+	ENGINE_PROFILE_SCOPE("ColliderBBManager::AddEntities");
+	pool.Reserve(pool.Size() + colliders.size());
+	size_t new_ids = colliders.size() - std::min(colliders.size(), m_free_ids.size());
+	m_slots.reserve(m_slots.size() + new_ids);
+	m_mobility.reserve(m_mobility.size() + new_ids);
+	m_category.reserve(m_category.size() + new_ids);
+	m_pending_move_of.reserve(m_pending_move_of.size() + new_ids);
+	std::vector<unsigned int> ids;
+	ids.reserve(colliders.size());
+	for (const TCollider& collider : colliders)
+		ids.push_back(Add(pool, shape, collider, mobility, category));
+	return ids;
+}
+
+template <Broadphase TBroadphase>
+std::vector<unsigned int> BasicColliderBBManager<TBroadphase>::AddEntities(std::span<const ColliderCircle> colliders, ColliderMobility mobility, ColliderCategory category)
+{
+	return AddMany(m_circles, ColliderShape::Circle, colliders, mobility, category);
+}
+
+template <Broadphase TBroadphase>
+std::vector<unsigned int> BasicColliderBBManager<TBroadphase>::AddEntities(std::span<const ColliderRect> colliders, ColliderMobility mobility, ColliderCategory category)
+{
+	return AddMany(m_rects, ColliderShape::Rect, colliders, mobility, category);
+}
+
+template <Broadphase TBroadphase>
+void BasicColliderBBManager<TBroadphase>::RebuildStaticTree()
+{
+	std::vector<StaticBVH::Entry> entries;
+	entries.reserve(m_static_count);
+	m_static_categories = 0;
+	for (unsigned int collider_id = 0; collider_id < m_slots.size(); ++collider_id)
+		if (IsAlive(collider_id) && m_mobility[collider_id] == ColliderMobility::Static)
+		{
+			entries.push_back({ collider_id, Visit(collider_id, [](auto& collider) -> const AABB& { return collider.GetBoundingBox(); }) });
+			m_static_categories |= m_category[collider_id];
+		}
+	m_static_tree.Build(entries, m_jobs);
+	m_static_tree_dirty = false;
+}
+
+template <Broadphase TBroadphase>
+void BasicColliderBBManager<TBroadphase>::TransformEntity(unsigned int collider_id, const glm::mat3& transformation)
+{
+	AABB old_aabb, new_aabb;
+	Visit(collider_id, [&](auto& collider) {
+		old_aabb = collider.GetBoundingBox();
+		collider.Transform(transformation);
+		new_aabb = collider.GetBoundingBox();
+		});
+	if (m_mobility[collider_id] == ColliderMobility::Static)
+	{
+		m_static_tree.Remove(collider_id);
+		m_static_tree_dirty = true;
+	}
+	else if (m_pending_move_of[collider_id] == s_no_slot)
+	{
+		// Later moves of the collider before the flush only change its final box
+		m_pending_move_of[collider_id] = static_cast<std::uint32_t>(m_pending_moves.size());
+		m_pending_moves.push_back({ collider_id, old_aabb });
+	}
+	m_changedCollider.push_back(collider_id);
+}
+
+template <Broadphase TBroadphase>
+void BasicColliderBBManager<TBroadphase>::Flush()
+{
+	FlushTransforms();
+	if constexpr (requires { m_broadphase.Flush(); })
+		m_broadphase.Flush();
+	if (m_static_tree_dirty || m_static_tree.RemovedCount() > m_static_tree.Size())
+		RebuildStaticTree();
+}
+
+template <Broadphase TBroadphase>
+void BasicColliderBBManager<TBroadphase>::FlushTransforms()
 {
-	++m_counter;
-	quadtree.Insert(m_counter, collider->GetBoundingBox());
-	m_colliders.emplace(m_counter, std::move(collider));
-	//m_changedCollider.emplace(m_counter);
-	return m_counter;
+	if (m_pending_moves.empty())
+		return;
+	ENGINE_PROFILE_SCOPE("ColliderBBManager::FlushTransforms");
+	for (const auto& move : m_pending_moves)
+	{
+		if (move.collider_id == s_no_slot)
+			continue;
+		m_broadphase.Update(move.collider_id, move.indexed_bb, Visit(move.collider_id, [](auto& collider) -> const AABB& { return collider.GetBoundingBox(); }));
+		m_pending_move_of[move.collider_id] = s_no_slot;
+	}
+	m_pending_moves.clear();
 }
 
-void ColliderBBManager::TransformEntity(unsigned int collider_id, const glm::mat3& transformation)
+template <Broadphase TBroadphase>
+void BasicColliderBBManager<TBroadphase>::DeleteEntity(unsigned int collider_id)
 {
-	auto collider_it = m_colliders.find(collider_id);
-	AABB old_aabb = collider_it->second->GetBoundingBox();
-	collider_it->second->Transform(transformation);
-	AABB new_aabb = collider_it->second->GetBoundingBox();
-	quadtree.Update(collider_id, old_aabb, new_aabb);
-	m_changedCollider.emplace(collider_id);
+	if (m_mobility[collider_id] == ColliderMobility::Static)
+	{
+		m_static_tree.Remove(collider_id);
+		--m_static_count;
+	}
+	else if (std::uint32_t pending = m_pending_move_of[collider_id]; pending != s_no_slot)
+	{
+		m_broadphase.Delete(collider_id, m_pending_moves[pending].indexed_bb);
+		m_pending_moves[pending].collider_id = s_no_slot;
+		m_pending_move_of[collider_id] = s_no_slot;
+	}
+	else
+		m_broadphase.Delete(collider_id, Visit(collider_id, [](auto& collider) -> const AABB& { return collider.GetBoundingBox(); }));
+	ColliderSlot& slot = m_slots[collider_id];
+	unsigned int moved = slot.shape == ColliderShape::Circle ? m_circles.Remove(slot.index) : m_rects.Remove(slot.index);
+	if (moved != ColliderPool<ColliderCircle>::s_none)
+		m_slots[moved].index = slot.index;
+	slot.index = s_no_slot;
+	m_free_ids.push_back(collider_id);
 }
 
-void ColliderBBManager::DeleteEntity(unsigned int collider_id)
+template <Broadphase TBroadphase>
+void BasicColliderBBManager<TBroadphase>::TestRange(std::span<const AABB> queries, std::span<const unsigned int> queried,
+	CircleRectBatch& batch, FrameVector<CircleRectCollideInfo>& contacts, FrameVector<ColliderCategory>& categories) const
 {
-	auto collider_it = m_colliders.find(collider_id);
-	quadtree.Delete(collider_id, collider_it->second->GetBoundingBox());
-	m_colliders.erase(collider_it);
+	// Candidates of the whole range come from one batched query where the structure has one,
+	// then are sorted back per collider with the static ones first
+	FrameVector<BroadphasePair> pairs{ FrameAllocator<BroadphasePair>(m_frame_arena) };
+	m_static_tree.GetIntersections(queries, pairs);
+	if constexpr (requires { m_broadphase.GetIntersections(queries, pairs); })
+		m_broadphase.GetIntersections(queries, pairs);
+	else
+	{
+		FrameVector<unsigned int> potential_col{ FrameAllocator<unsigned int>(m_frame_arena) };
+		for (std::uint32_t query = 0; query < queries.size(); ++query)
+		{
+			// Broadphases that track overlapping pairs answer without a query for their own colliders
+			constexpr bool tracks_pairs = requires { m_broadphase.ForEachOverlap(0u, [](unsigned int) {}); };
+			if (tracks_pairs && m_mobility[queried[query]] == ColliderMobility::Dynamic)
+			{
+				if constexpr (tracks_pairs)
+					m_broadphase.ForEachOverlap(queried[query], [&pairs, query](unsigned int col_indexB) { pairs.push_back({ query, col_indexB }); });
+				continue;
+			}
+			potential_col.clear();
+			m_broadphase.GetIntersection(queries[query], potential_col);
+			for (auto col_indexB : potential_col)
+				pairs.push_back({ query, col_indexB });
+		}
+	}
+	std::stable_sort(pairs.begin(), pairs.end(), [](const BroadphasePair& a, const BroadphasePair& b) { return a.query < b.query; });
+
+	// Pairs go to the batch of their shapes through the pair table, no virtual call
+	batch.Clear();
+	for (const auto& pair : pairs)
+	{
+		unsigned int col_indexA = queried[pair.query];
+		auto shapeA = static_cast<size_t>(m_slots[col_indexA].shape), shapeB = static_cast<size_t>(m_slots[pair.id].shape);
+		if (PairCollector collect = s_pair_collectors[shapeA][shapeB])
+			collect(*this, col_indexA, pair.id, batch);
+	}
+	batch.Evaluate(contacts, categories);
 }
 
-bool ColliderBBManager::Update(float time)
+template <Broadphase TBroadphase>
+bool BasicColliderBBManager<TBroadphase>::Update(float time)
 {
-	auto changedCollider = std::move(m_changedCollider);
-	for (auto col_indexA : changedCollider)
+	ENGINE_PROFILE_SCOPE("ColliderBBManager::Update");
+	// Collision callbacks may move colliders again, those are picked up next frame
+	std::swap(m_changedCollider, m_testedCollider);
+	std::sort(m_testedCollider.begin(), m_testedCollider.end());
+	m_testedCollider.erase(std::unique(m_testedCollider.begin(), m_testedCollider.end()), m_testedCollider.end());
+	Flush();
+
+	FrameVector<AABB> boxes{ FrameAllocator<AABB>(m_frame_arena) };
+	FrameVector<unsigned int> queried{ FrameAllocator<unsigned int>(m_frame_arena) };
+	boxes.reserve(m_testedCollider.size());
+	queried.reserve(m_testedCollider.size());
+	for (auto col_indexA : m_testedCollider)
+	{
+		if (IsAlive(col_indexA))
+		{
+			boxes.push_back(Visit(col_indexA, [](auto& collider) -> const AABB& { return collider.GetBoundingBox(); }));
+			queried.push_back(col_indexA);
+		}
+	}
+
+	// Chunks of the tested colliders are checked in parallel against the read-only structures,
+	// each into its own contact list; the lists are merged in chunk order so callbacks run on
+	// this thread in the same order as a serial pass
+	FrameVector<CircleRectCollideInfo> contacts{ FrameAllocator<CircleRectCollideInfo>(m_frame_arena) };
+	FrameVector<ColliderCategory> categories{ FrameAllocator<ColliderCategory>(m_frame_arena) };
+	size_t chunk_count = (queried.size() + s_chunk_size - 1) / s_chunk_size;
+	if (!m_jobs || chunk_count <= 1)
+		TestRange(boxes, queried, m_narrowphase ? m_narrowphase->Local() : m_circle_rect_pairs, contacts, categories);
+	else
 	{
-		auto it = m_colliders.find(col_indexA);
-		if (it != m_colliders.end())
+		struct ChunkContacts
 		{
-			const auto& colliderA = it->second;
-			for (auto potential_col = quadtree.GetIntersection(colliderA->GetBoundingBox());
-				auto col_indexB : potential_col)
-				colliderA->Test(m_colliders[col_indexB].get());
+			FrameVector<CircleRectCollideInfo> contacts;
+			FrameVector<ColliderCategory> categories;
+		};
+		std::vector<ChunkContacts> chunks;
+		chunks.reserve(chunk_count);
+		for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+			chunks.push_back({ FrameVector<CircleRectCollideInfo>(FrameAllocator<CircleRectCollideInfo>(m_frame_arena)),
+				FrameVector<ColliderCategory>(FrameAllocator<ColliderCategory>(m_frame_arena)) });
+		m_jobs->ParallelFor(0, chunk_count, [&](size_t chunk) {
+			size_t begin = chunk * s_chunk_size;
+			size_t count = std::min(s_chunk_size, queried.size() - begin);
+			TestRange(std::span<const AABB>(boxes).subspan(begin, count), std::span<const unsigned int>(queried).subspan(begin, count),
+				m_narrowphase->Local(), chunks[chunk].contacts, chunks[chunk].categories);
+			}, 1);
+		for (const auto& chunk : chunks)
+		{
+			contacts.insert(contacts.end(), chunk.contacts.begin(), chunk.contacts.end());
+			categories.insert(categories.end(), chunk.categories.begin(), chunk.categories.end());
 		}
 	}
+	contacts.insert(contacts.end(), m_reported.begin(), m_reported.end());
+	categories.insert(categories.end(), m_reported_categories.begin(), m_reported_categories.end());
+	m_reported.clear();
+	m_reported_categories.clear();
+	Dispatch(contacts, categories);
+	m_testedCollider.clear();
 
 	return true;
-}
\ No newline at end of file
+}
+
+template <Broadphase TBroadphase>
+const std::array<typename BasicColliderBBManager<TBroadphase>::SweepTest, BasicColliderBBManager<TBroadphase>::s_shape_count>
+	BasicColliderBBManager<TBroadphase>::s_sweep_tests = {
+		[](const BasicColliderBBManager& manager, const Circle& circle, glm::vec2 motion, std::uint32_t index) {
+			return SweepCircleCircle(circle, motion, manager.m_circles[index].GetCircle());
+		},
+		[](const BasicColliderBBManager& manager, const Circle& circle, glm::vec2 motion, std::uint32_t index) {
+			return SweepCircleRect(circle, motion, manager.m_rects[index].GetRect());
+		},
+	};
+
+template <Broadphase TBroadphase>
+std::optional<CircleCastHit> BasicColliderBBManager<TBroadphase>::CastCircle(const Circle& circle, glm::vec2 motion, ColliderCategory categories) const
+{
+	std::optional<CircleCastHit> first;
+	auto test = [&](unsigned int collider_id) {
+		const ColliderSlot& slot = m_slots[collider_id];
+		if ((m_category[collider_id] & categories) == 0)
+			return std::numeric_limits<float>::infinity();
+		std::optional<SweepHit> hit = s_sweep_tests[static_cast<size_t>(slot.shape)](*this, circle, motion, slot.index);
+		if (!hit || (first && first->time <= hit->time))
+			return std::numeric_limits<float>::infinity();
+		first = CircleCastHit{ hit->time, hit->normal, collider_id };
+		return hit->time;
+		};
+
+	float max_time = 1.f;
+	if (m_static_categories & categories)
+		max_time = m_static_tree.Raycast(circle.pos, motion, circle.radius, max_time, test);
+	if ((m_dynamic_categories & categories) == 0)
+		return first;
+	if constexpr (requires { m_broadphase.Raycast(circle.pos, motion, circle.radius, max_time, test); })
+		m_broadphase.Raycast(circle.pos, motion, circle.radius, max_time, test);
+	else
+	{
+		// Broadphases without a front to back walk are queried with the box of the whole sweep
+		glm::vec2 end = circle.pos + max_time * motion;
+		AABB swept{ glm::max(circle.pos, end) + glm::vec2(circle.radius), glm::min(circle.pos, end) - glm::vec2(circle.radius) };
+		FrameVector<unsigned int> candidates{ FrameAllocator<unsigned int>(m_frame_arena) };
+		m_broadphase.GetIntersection(swept, candidates);
+		for (auto collider_id : candidates)
+			test(collider_id);
+	}
+	return first;
+}
+
+template <Broadphase TBroadphase>
+void BasicColliderBBManager<TBroadphase>::CastCircles(std::span<const CircleCast> casts, std::span<std::optional<CircleCastHit>> hits) const
+{
+	ENGINE_PROFILE_SCOPE("ColliderBBManager::CastCircles");
+	auto cast_range = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+			hits[i] = CastCircle(casts[i].circle, casts[i].motion, casts[i].categories);
+		};
+	if (m_jobs)
+		m_jobs->ParallelForRange(0, casts.size(), s_cast_chunk_size, cast_range);
+	else
+		cast_range(0, casts.size());
+}
+
+template <Broadphase TBroadphase>
+const std::array<typename BasicColliderBBManager<TBroadphase>::DistanceTest, BasicColliderBBManager<TBroadphase>::s_shape_count>
+	BasicColliderBBManager<TBroadphase>::s_distance_tests = {
+		[](const BasicColliderBBManager& manager, glm::vec2 point, std::uint32_t index) {
+			return Distance(point, manager.m_circles[index].GetCircle());
+		},
+		[](const BasicColliderBBManager& manager, glm::vec2 point, std::uint32_t index) {
+			return Distance(point, manager.m_rects[index].GetRect());
+		},
+	};
+
+template <Broadphase TBroadphase>
+size_t BasicColliderBBManager<TBroadphase>::FindNear(glm::vec2 point, float max_distance, bool shrink, std::span<ColliderDistance> found, ColliderCategory categories) const
+{
+	size_t count = 0, within = 0;
+	auto bound = [&]() {
+		return shrink && count == found.size() ? found[count - 1].distance : max_distance;
+		};
+	auto test = [&](unsigned int collider_id) {
+		const ColliderSlot& slot = m_slots[collider_id];
+		if ((m_category[collider_id] & categories) == 0)
+			return bound();
+		float distance = s_distance_tests[static_cast<size_t>(slot.shape)](*this, point, slot.index);
+		if (distance > bound())
+			return bound();
+		++within;
+		if (count == found.size() && (count == 0 || found[count - 1].distance <= distance))
+			return bound();
+		// Insertion into the sorted buffer, dropping the farthest entry when it is full
+		size_t i = count < found.size() ? count++ : count - 1;
+		for (; i > 0 && found[i - 1].distance > distance; --i)
+			found[i] = found[i - 1];
+		found[i] = { distance, collider_id };
+		return bound();
+		};
+
+	if (m_static_categories & categories)
+		m_static_tree.Nearest(point, bound(), test);
+	if ((m_dynamic_categories & categories) == 0)
+		return shrink ? count : within;
+	if constexpr (requires { m_broadphase.Nearest(point, max_distance, test); })
+		m_broadphase.Nearest(point, bound(), test);
+	else
+	{
+		// Broadphases without a nearest first walk are queried with the box of the bound, or
+		// every dynamic collider is tested while the bound is still unlimited
+		FrameVector<unsigned int> candidates{ FrameAllocator<unsigned int>(m_frame_arena) };
+		float distance = bound();
+		if (distance < std::numeric_limits<float>::infinity())
+			m_broadphase.GetIntersection(AABB{ point + glm::vec2(distance), point - glm::vec2(distance) }, candidates);
+		else
+			for (unsigned int collider_id = 0; collider_id < m_slots.size(); ++collider_id)
+				if (IsAlive(collider_id) && m_mobility[collider_id] == ColliderMobility::Dynamic)
+					candidates.push_back(collider_id);
+		for (auto collider_id : candidates)
+			test(collider_id);
+	}
+	return shrink ? count : within;
+}
+
+template <Broadphase TBroadphase>
+size_t BasicColliderBBManager<TBroadphase>::FindNearest(glm::vec2 point, std::span<ColliderDistance> nearest, ColliderCategory categories) const
+{
+	ENGINE_PROFILE_SCOPE("ColliderBBManager::FindNearest");
+	if (nearest.empty())
+		return 0;
+	return FindNear(point, std::numeric_limits<float>::infinity(), true, nearest, categories);
+}
+
+template <Broadphase TBroadphase>
+size_t BasicColliderBBManager<TBroadphase>::FindWithinRadius(glm::vec2 point, float radius, std::span<ColliderDistance> within, ColliderCategory categories) const
+{
+	ENGINE_PROFILE_SCOPE("ColliderBBManager::FindWithinRadius");
+	return FindNear(point, radius, false, within, categories);
+}
+
+template <Broadphase TBroadphase>
+void BasicColliderBBManager<TBroadphase>::ReportContact(unsigned int circle_collider_id, unsigned int rect_collider_id, glm::vec2 normal)
+{
+	const ColliderCircle& circle = m_circles[m_slots[circle_collider_id].index];
+	const ColliderRect& rect = m_rects[m_slots[rect_collider_id].index];
+	m_reported.push_back({ normal, circle.GetId(), rect.GetId() });
+	m_reported_categories.push_back(m_category[rect_collider_id]);
+}
+
+template <Broadphase TBroadphase>
+void BasicColliderBBManager<TBroadphase>::Dispatch(std::span<const CircleRectCollideInfo> contacts, std::span<const ColliderCategory> categories)
+{
+	if (contacts.empty())
+		return;
+	ColliderCategory present = 0;
+	for (auto category : categories)
+		present |= category;
+	FrameVector<CircleRectCollideInfo> filtered{ FrameAllocator<CircleRectCollideInfo>(m_frame_arena) };
+	for (const auto& subscription : m_subscriptions)
+	{
+		if ((present & subscription.categories) == 0)
+			continue;
+		// Every contact passes when all categories present are in the filter
+		if ((present & ~subscription.categories) == 0)
+		{
+			subscription.callback(contacts);
+			continue;
+		}
+		filtered.clear();
+		for (size_t i = 0; i < contacts.size(); ++i)
+			if (categories[i] & subscription.categories)
+				filtered.push_back(contacts[i]);
+		if (!filtered.empty())
+			subscription.callback(filtered);
+	}
+}
+
+template <Broadphase TBroadphase>
+unsigned int BasicColliderBBManager<TBroadphase>::Subscribe(ColliderCategory categories, ContactCallback callback)
+{
+	m_subscriptions.push_back({ m_next_subscription, categories, std::move(callback) });
+	return m_next_subscription++;
+}
+
+template <Broadphase TBroadphase>
+void BasicColliderBBManager<TBroadphase>::Unsubscribe(unsigned int subscription)
+{
+	std::erase_if(m_subscriptions, [subscription](const Subscription& s) { return s.id == subscription; });
+}
+
+template class BasicColliderBBManager<Quadtree>;
+template class BasicColliderBBManager<LinearQuadtree>;
+template class BasicColliderBBManager<SpatialHash>;
+template class BasicColliderBBManager<SweepAndPrune>;
@@ -0,0 +1,174 @@
+#include "collider_manager/linear_quadtree.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+LinearQuadtree::LinearQuadtree(glm::vec2 pos, float width) :
+	m_pos(pos),
+	m_width(width),
+	m_inverse_cell_size(s_grid_size / width),
+	m_nodes(LevelOffset(s_max_depth + 1))
+{}
+
+std::uint32_t LinearQuadtree::Morton(std::uint32_t x, std::uint32_t y)
+{
+	auto spread = [](std::uint32_t v) {
+		v &= 0x0000FFFF;
+		v = (v | (v << 8)) & 0x00FF00FF;
+		v = (v | (v << 4)) & 0x0F0F0F0F;
+		v = (v | (v << 2)) & 0x33333333;
+		v = (v | (v << 1)) & 0x55555555;
+		return v;
+		};
+	return spread(x) | (spread(y) << 1);
+}
+
+LinearQuadtree::GridRange LinearQuadtree::Quantize(const AABB& bb) const
+{
+	auto cell = [this](float coordinate, float origin) {
+		float c = std::floor((coordinate - origin) * m_inverse_cell_size);
+		return static_cast<std::uint32_t>(std::clamp(c, 0.f, static_cast<float>(s_grid_size - 1)));
+		};
+	return { cell(bb.min.x, m_pos.x), cell(bb.min.y, m_pos.y), cell(bb.max.x, m_pos.x), cell(bb.max.y, m_pos.y) };
+}
+
+LinearQuadtree::Location LinearQuadtree::Locate(const AABB& bb) const
+{
+	GridRange range = Quantize(bb);
+	// The deepest common cell of both corners: drop the bits where they differ
+	unsigned int shift = std::bit_width((range.min_x ^ range.max_x) | (range.min_y ^ range.max_y));
+	return { s_max_depth - shift, range.min_x >> shift, range.min_y >> shift };
+}
+
+void LinearQuadtree::AddToSubtreeCounts(const Location& location, int delta)
+{
+	for (unsigned int level = 0; level <= location.level; ++level)
+	{
+		unsigned int shift = location.level - level;
+		m_nodes[NodeIndex({ level, location.x >> shift, location.y >> shift })].subtree_count += delta;
+	}
+}
+
+void LinearQuadtree::Grow(Node& node)
+{
+	std::uint32_t capacity = std::max<std::uint32_t>(4, node.capacity * 2);
+	auto begin = static_cast<std::uint32_t>(m_boxes.Size());
+	m_boxes.Resize(m_boxes.Size() + capacity);
+	m_ids.resize(m_ids.size() + capacity);
+	for (std::uint32_t i = 0; i < node.count; ++i)
+	{
+		m_boxes.Set(begin + i, m_boxes.Get(node.begin + i));
+		m_ids[begin + i] = m_ids[node.begin + i];
+		m_slot_of_id[m_ids[begin + i]] = begin + i;
+	}
+	m_garbage += node.capacity;
+	node.begin = begin;
+	node.capacity = capacity;
+}
+
+void LinearQuadtree::Compact()
+{
+	auto slack = [](std::uint32_t count) { return count == 0 ? 0 : count + count / 4 + 1; };
+	size_t size = 0;
+	for (const auto& node : m_nodes)
+		size += slack(node.count);
+
+	AABBColumns boxes;
+	boxes.Resize(size);
+	std::vector<unsigned int> ids(size);
+	std::uint32_t begin = 0;
+	for (auto& node : m_nodes)
+	{
+		std::copy_n(m_ids.begin() + node.begin, node.count, ids.begin() + begin);
+		for (std::uint32_t i = 0; i < node.count; ++i)
+		{
+			boxes.Set(begin + i, m_boxes.Get(node.begin + i));
+			m_slot_of_id[ids[begin + i]] = begin + i;
+		}
+		node.begin = begin;
+		node.capacity = slack(node.count);
+		begin += node.capacity;
+	}
+	m_boxes = std::move(boxes);
+	m_ids = std::move(ids);
+	m_garbage = 0;
+}
+
+void LinearQuadtree::InsertAt(unsigned int id, const AABB& bb, const Location& location)
+{
+	Node& node = m_nodes[NodeIndex(location)];
+	if (node.count == node.capacity)
+		Grow(node);
+	std::uint32_t slot = node.begin + node.count++;
+	m_boxes.Set(slot, bb);
+	m_ids[slot] = id;
+	if (id >= m_slot_of_id.size())
+		m_slot_of_id.resize(std::max<size_t>(id + 1, m_slot_of_id.size() * 2), s_invalid);
+	m_slot_of_id[id] = slot;
+	AddToSubtreeCounts(location, 1);
+
+	if (m_garbage > 1024 && m_garbage * 4 > m_boxes.Size())
+		Compact();
+}
+
+void LinearQuadtree::RemoveAt(unsigned int id, const Location& location)
+{
+	Node& node = m_nodes[NodeIndex(location)];
+	std::uint32_t slot = m_slot_of_id[id];
+	std::uint32_t last = node.begin + --node.count;
+	if (slot != last)
+	{
+		m_boxes.Set(slot, m_boxes.Get(last));
+		m_ids[slot] = m_ids[last];
+		m_slot_of_id[m_ids[slot]] = slot;
+	}
+	m_slot_of_id[id] = s_invalid;
+	AddToSubtreeCounts(location, -1);
+}
+
+void LinearQuadtree::Insert(unsigned int id, const AABB& bb)
+{
+	ENGINE_PROFILE_SCOPE("LinearQuadtree::Insert");
+	if (Contains(bb))
+		InsertAt(id, bb, Locate(bb));
+}
+
+void LinearQuadtree::Delete(unsigned int id, const AABB& bb)
+{
+	ENGINE_PROFILE_SCOPE("LinearQuadtree::Delete");
+	if (id < m_slot_of_id.size() && m_slot_of_id[id] != s_invalid && Contains(bb))
+		RemoveAt(id, Locate(bb));
+}
+
+void LinearQuadtree::Update(unsigned int id, const AABB& old_bb, const AABB& new_bb)
+{
+	bool was_inside = id < m_slot_of_id.size() && m_slot_of_id[id] != s_invalid && Contains(old_bb);
+	bool is_inside = Contains(new_bb);
+	if (was_inside && is_inside)
+	{
+		Location old_location = Locate(old_bb);
+		Location new_location = Locate(new_bb);
+		if (old_location.level == new_location.level && old_location.x == new_location.x && old_location.y == new_location.y)
+		{
+			m_boxes.Set(m_slot_of_id[id], new_bb);
+			return;
+		}
+		RemoveAt(id, old_location);
+		InsertAt(id, new_bb, new_location);
+		return;
+	}
+	if (was_inside)
+		RemoveAt(id, Locate(old_bb));
+	if (is_inside)
+		InsertAt(id, new_bb, Locate(new_bb));
+}
+
+std::vector<size_t> LinearQuadtree::ItemsPerLevel() const
+{
+	std::vector<size_t> items_per_level(s_max_depth + 1);
+	for (unsigned int level = 0; level <= s_max_depth; ++level)
+		for (std::uint32_t index = LevelOffset(level); index < LevelOffset(level + 1); ++index)
+			items_per_level[level] += m_nodes[index].count;
+	return items_per_level;
+}
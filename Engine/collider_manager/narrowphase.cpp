@@ -0,0 +1,81 @@
+#include "collider_manager/narrowphase.hpp"
+
+#include <algorithm>
+
+void CircleRectBatch::Clear()
+{
+	for (auto* column : { &m_circle_x, &m_circle_y, &m_reach, &m_start_x, &m_start_y, &m_axis_x, &m_axis_y })
+		column->clear();
+	m_circle_ids.clear();
+	m_rect_ids.clear();
+	m_tags.clear();
+	m_size = 0;
+}
+
+void CircleRectBatch::Add(const Circle& circle, unsigned int circle_id, const Rect& rect, unsigned int rect_id, std::uint32_t tag)
+{
+	// Columns may hold the padding of a previous Evaluate
+	if (m_circle_x.size() > m_size)
+		for (auto* column : { &m_circle_x, &m_circle_y, &m_reach, &m_start_x, &m_start_y, &m_axis_x, &m_axis_y })
+			column->resize(m_size);
+	m_circle_x.push_back(circle.pos.x);
+	m_circle_y.push_back(circle.pos.y);
+	m_reach.push_back(circle.radius + rect.height);
+	m_start_x.push_back(rect.start.x);
+	m_start_y.push_back(rect.start.y);
+	m_axis_x.push_back(rect.end.x - rect.start.x);
+	m_axis_y.push_back(rect.end.y - rect.start.y);
+	m_circle_ids.push_back(circle_id);
+	m_rect_ids.push_back(rect_id);
+	m_tags.push_back(tag);
+	++m_size;
+}
+
+void CircleRectBatch::Pad()
+{
+	// Padding lanes hold zeros and are masked off; their axis is degenerate, which is harmless
+	for (auto* column : { &m_circle_x, &m_circle_y, &m_reach, &m_start_x, &m_start_y, &m_axis_x, &m_axis_y })
+		column->resize(m_size + simd_width - 1);
+}
+
+unsigned int CircleRectBatch::ContactMask(size_t first, float* normal_x, float* normal_y) const
+{
+#if defined(ENGINE_SIMD_AVX2)
+	__m256 axis_x = _mm256_loadu_ps(&m_axis_x[first]), axis_y = _mm256_loadu_ps(&m_axis_y[first]);
+	__m256 start_x = _mm256_loadu_ps(&m_start_x[first]), start_y = _mm256_loadu_ps(&m_start_y[first]);
+	__m256 circle_x = _mm256_loadu_ps(&m_circle_x[first]), circle_y = _mm256_loadu_ps(&m_circle_y[first]);
+	__m256 reach = _mm256_loadu_ps(&m_reach[first]);
+
+	__m256 along = _mm256_add_ps(_mm256_mul_ps(axis_x, _mm256_sub_ps(circle_x, start_x)), _mm256_mul_ps(axis_y, _mm256_sub_ps(circle_y, start_y)));
+	__m256 length2 = _mm256_add_ps(_mm256_mul_ps(axis_x, axis_x), _mm256_mul_ps(axis_y, axis_y));
+	__m256 t = _mm256_min_ps(_mm256_max_ps(_mm256_div_ps(along, length2), _mm256_setzero_ps()), _mm256_set1_ps(1.f));
+	__m256 n_x = _mm256_sub_ps(circle_x, _mm256_add_ps(start_x, _mm256_mul_ps(t, axis_x)));
+	__m256 n_y = _mm256_sub_ps(circle_y, _mm256_add_ps(start_y, _mm256_mul_ps(t, axis_y)));
+	__m256 distance2 = _mm256_add_ps(_mm256_mul_ps(n_x, n_x), _mm256_mul_ps(n_y, n_y));
+	_mm256_store_ps(normal_x, n_x);
+	_mm256_store_ps(normal_y, n_y);
+	return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(distance2, _mm256_mul_ps(reach, reach), _CMP_LT_OQ)));
+#elif defined(ENGINE_SIMD_SSE2)
+	__m128 axis_x = _mm_loadu_ps(&m_axis_x[first]), axis_y = _mm_loadu_ps(&m_axis_y[first]);
+	__m128 start_x = _mm_loadu_ps(&m_start_x[first]), start_y = _mm_loadu_ps(&m_start_y[first]);
+	__m128 circle_x = _mm_loadu_ps(&m_circle_x[first]), circle_y = _mm_loadu_ps(&m_circle_y[first]);
+	__m128 reach = _mm_loadu_ps(&m_reach[first]);
+
+	__m128 along = _mm_add_ps(_mm_mul_ps(axis_x, _mm_sub_ps(circle_x, start_x)), _mm_mul_ps(axis_y, _mm_sub_ps(circle_y, start_y)));
+	__m128 length2 = _mm_add_ps(_mm_mul_ps(axis_x, axis_x), _mm_mul_ps(axis_y, axis_y));
+	__m128 t = _mm_min_ps(_mm_max_ps(_mm_div_ps(along, length2), _mm_setzero_ps()), _mm_set1_ps(1.f));
+	__m128 n_x = _mm_sub_ps(circle_x, _mm_add_ps(start_x, _mm_mul_ps(t, axis_x)));
+	__m128 n_y = _mm_sub_ps(circle_y, _mm_add_ps(start_y, _mm_mul_ps(t, axis_y)));
+	__m128 distance2 = _mm_add_ps(_mm_mul_ps(n_x, n_x), _mm_mul_ps(n_y, n_y));
+	_mm_store_ps(normal_x, n_x);
+	_mm_store_ps(normal_y, n_y);
+	return static_cast<unsigned int>(_mm_movemask_ps(_mm_cmplt_ps(distance2, _mm_mul_ps(reach, reach))));
+#else
+	float along = m_axis_x[first] * (m_circle_x[first] - m_start_x[first]) + m_axis_y[first] * (m_circle_y[first] - m_start_y[first]);
+	float length2 = m_axis_x[first] * m_axis_x[first] + m_axis_y[first] * m_axis_y[first];
+	float t = std::clamp(along / length2, 0.f, 1.f);
+	normal_x[0] = m_circle_x[first] - (m_start_x[first] + t * m_axis_x[first]);
+	normal_y[0] = m_circle_y[first] - (m_start_y[first] + t * m_axis_y[first]);
+	return normal_x[0] * normal_x[0] + normal_y[0] * normal_y[0] < m_reach[first] * m_reach[first];
+#endif
+}
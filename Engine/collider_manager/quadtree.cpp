@@ -3,6 +3,19 @@
 Quadtree::QuadtreeNode::Quads Quadtree::QuadtreeNode::GetQuad(const AABB& bb) const
 {
 	glm::vec2 center = m_pos + glm::vec2(m_width / 2);
+	if (m_looseness > 1.f)
+	{
+		// The child holding the item's centre, if the item fits in its loose bounds
+		glm::vec2 item_center = 0.5f * (bb.max + bb.min);
+		glm::vec2 half_extent = 0.5f * (bb.max - bb.min);
+		float max_half_extent = m_width / 4.f * (m_looseness - 1.f);
+		if (half_extent.x >= max_half_extent || half_extent.y >= max_half_extent)
+			return None;
+		if (item_center.x < center.x)
+			return item_center.y < center.y ? BottomLeft : TopLeft;
+		return item_center.y < center.y ? BottomRight : TopRight;
+	}
+
 	if (bb.max.x < center.x)
 	{
 		if (bb.max.y < center.y)
@@ -29,10 +42,10 @@ void Quadtree::QuadtreeNode::Subdivide()
 {
 	assert(IsTerminate());
 
-	quads[TopRight] = std::make_unique<QuadtreeNode>(m_pos + glm::vec2(m_width / 2), m_width / 2);
-	quads[TopLeft] = std::make_unique<QuadtreeNode>(m_pos + glm::vec2(0, m_width / 2), m_width / 2);
-	quads[BottomRight] = std::make_unique<QuadtreeNode>(m_pos + glm::vec2(m_width / 2, 0), m_width / 2);
-	quads[BottomLeft] = std::make_unique<QuadtreeNode>(m_pos, m_width / 2);
+	quads[TopRight] = std::make_unique<QuadtreeNode>(m_pos + glm::vec2(m_width / 2), m_width / 2, m_looseness);
+	quads[TopLeft] = std::make_unique<QuadtreeNode>(m_pos + glm::vec2(0, m_width / 2), m_width / 2, m_looseness);
+	quads[BottomRight] = std::make_unique<QuadtreeNode>(m_pos + glm::vec2(m_width / 2, 0), m_width / 2, m_looseness);
+	quads[BottomLeft] = std::make_unique<QuadtreeNode>(m_pos, m_width / 2, m_looseness);
 
 	std::unordered_map<unsigned int, AABB> items;
 	for (auto& bb : m_items)
@@ -57,7 +70,7 @@ void Quadtree::QuadtreeNode::Merge()
 		element_size += quads[i]->m_items.size();
 	}
 	element_size += m_items.size();
-	if (element_size <= s_max_el_count)
+	if (element_size <= s_merge_el_count)
 	{
 		for (int i = 0; i < 4; ++i)
 		{
@@ -115,18 +128,29 @@ void Quadtree::QuadtreeNode::Remove(unsigned int id, const AABB& bb, QuadtreeNod
 	}
 }
 
-void Quadtree::QuadtreeNode::IntersectQuery(const AABB& bb, std::vector<unsigned int>& intersection_ids) const
+bool Quadtree::QuadtreeNode::Move(unsigned int id, const AABB& old_bb, const AABB& new_bb)
 {
-
-	for (const auto& val_p : m_items)
+	if (!IsTerminate())
 	{
-		if (intersects(val_p.second, bb))
-			intersection_ids.push_back(val_p.first);
+		Quads q = GetQuad(old_bb);
+		if (q != GetQuad(new_bb))
+			return false;
+		if (q != Quads::None)
+			return quads[q]->Move(id, old_bb, new_bb);
 	}
+	auto it = m_items.find(id);
+	if (it == m_items.end())
+		return false;
+	it->second = new_bb;
+	return true;
+}
+
+void Quadtree::QuadtreeNode::CountItems(std::vector<size_t>& items_per_level, size_t depth) const
+{
+	if (items_per_level.size() <= depth)
+		items_per_level.resize(depth + 1);
+	items_per_level[depth] += m_items.size();
 	if (!IsTerminate())
-	{
 		for (int i = 0; i < 4; ++i)
-			if (quads[i]->Intersects(bb))
-				quads[i]->IntersectQuery(bb, intersection_ids);
-	}
-}
\ No newline at end of file
+			quads[i]->CountItems(items_per_level, depth + 1);
+}
@@ -0,0 +1,108 @@
+#include "collider_manager/spatial_hash.hpp"
+
+#include <bit>
+#include <cmath>
+
+SpatialHash::SpatialHash(glm::vec2 pos, float width, float cell_size) :
+	m_pos(pos),
+	m_width(width)
+{
+	if (cell_size <= 0.f)
+		cell_size = width / 64.f;
+	m_inverse_cell_size = 1.f / cell_size;
+	m_cells_per_side = std::max(1, static_cast<std::int32_t>(std::ceil(width * m_inverse_cell_size)));
+	auto cell_count = static_cast<std::uint64_t>(m_cells_per_side) * m_cells_per_side;
+	auto bucket_count = std::bit_ceil(static_cast<std::uint32_t>(std::min<std::uint64_t>(cell_count, s_max_bucket_count)));
+	m_bucket_mask = bucket_count - 1;
+	m_buckets.resize(bucket_count);
+}
+
+SpatialHash::CellRange SpatialHash::Cells(const AABB& bb) const
+{
+	auto cell = [this](float coordinate, float origin) {
+		float c = std::floor((coordinate - origin) * m_inverse_cell_size);
+		return static_cast<std::int32_t>(std::clamp(c, 0.f, static_cast<float>(m_cells_per_side - 1)));
+		};
+	return { cell(bb.min.x, m_pos.x), cell(bb.min.y, m_pos.y), cell(bb.max.x, m_pos.x), cell(bb.max.y, m_pos.y) };
+}
+
+void SpatialHash::CollectBuckets(const CellRange& cells)
+{
+	m_item_buckets.clear();
+	for (std::int32_t y = cells.min_y; y <= cells.max_y; ++y)
+		for (std::int32_t x = cells.min_x; x <= cells.max_x; ++x)
+			m_item_buckets.push_back(Hash(x, y));
+	if (m_item_buckets.size() > 1)
+	{
+		std::sort(m_item_buckets.begin(), m_item_buckets.end());
+		m_item_buckets.erase(std::unique(m_item_buckets.begin(), m_item_buckets.end()), m_item_buckets.end());
+	}
+}
+
+void SpatialHash::InsertCells(unsigned int id, const CellRange& cells)
+{
+	CollectBuckets(cells);
+	for (auto bucket : m_item_buckets)
+		m_buckets[bucket].push_back(id);
+}
+
+void SpatialHash::RemoveCells(unsigned int id, const CellRange& cells)
+{
+	CollectBuckets(cells);
+	for (auto bucket : m_item_buckets)
+	{
+		auto& ids = m_buckets[bucket];
+		auto it = std::find(ids.begin(), ids.end(), id);
+		if (it == ids.end())
+			continue;
+		*it = ids.back();
+		ids.pop_back();
+	}
+}
+
+void SpatialHash::Insert(unsigned int id, const AABB& bb)
+{
+	ENGINE_PROFILE_SCOPE("SpatialHash::Insert");
+	if (!Contains(bb) || IsPresent(id))
+		return;
+	if (id >= m_boxes.size())
+	{
+		m_boxes.resize(std::max<size_t>(id + 1, m_boxes.size() * 2));
+		m_present.resize(m_boxes.size());
+	}
+	m_boxes[id] = bb;
+	m_present[id] = true;
+	++m_size;
+	InsertCells(id, Cells(bb));
+}
+
+void SpatialHash::Delete(unsigned int id, const AABB&)
+{
+	ENGINE_PROFILE_SCOPE("SpatialHash::Delete");
+	if (!IsPresent(id))
+		return;
+	RemoveCells(id, Cells(m_boxes[id]));
+	m_present[id] = false;
+	--m_size;
+}
+
+void SpatialHash::Update(unsigned int id, const AABB& old_bb, const AABB& new_bb)
+{
+	if (!IsPresent(id))
+	{
+		Insert(id, new_bb);
+		return;
+	}
+	if (!Contains(new_bb))
+	{
+		Delete(id, old_bb);
+		return;
+	}
+	CellRange old_cells = Cells(m_boxes[id]);
+	CellRange new_cells = Cells(new_bb);
+	m_boxes[id] = new_bb;
+	if (old_cells == new_cells)
+		return;
+	RemoveCells(id, old_cells);
+	InsertCells(id, new_cells);
+}
@@ -0,0 +1,213 @@
+#include "collider_manager/static_bvh.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	AABB EmptyBox()
+	{
+		float inf = std::numeric_limits<float>::infinity();
+		return { glm::vec2(-inf), glm::vec2(inf) };
+	}
+
+	void Grow(AABB& bb, const AABB& other)
+	{
+		bb.max = glm::max(bb.max, other.max);
+		bb.min = glm::min(bb.min, other.min);
+	}
+
+	// Half perimeter, the 2D counterpart of the surface area in the SAH cost
+	float HalfPerimeter(const AABB& bb)
+	{
+		glm::vec2 extent = bb.max - bb.min;
+		return extent.x + extent.y;
+	}
+
+	glm::vec2 Centre(const AABB& bb)
+	{
+		return 0.5f * (bb.max + bb.min);
+	}
+}
+
+void StaticBVH::Build(const std::vector<Entry>& entries, JobSystem* jobs)
+{
+	ENGINE_PROFILE_SCOPE("StaticBVH::Build");
+	std::vector<Item> items;
+	items.reserve(entries.size());
+	for (const auto& entry : entries)
+		items.push_back({ entry.bb, entry.id });
+	m_nodes.clear();
+	m_nodes.reserve(entries.empty() ? 0 : 2 * entries.size() / s_max_leaf_size + 1);
+	m_removed = 0;
+	auto count = static_cast<std::uint32_t>(items.size());
+	if (!jobs || count < 2 * s_min_subtree_size)
+	{
+		if (count > 0)
+			BuildNode(m_nodes, items, 0, count, 0);
+	}
+	else
+	{
+		// A few subtrees per thread, built concurrently on disjoint ranges of items
+		auto subtree_size = std::max<std::uint32_t>(s_min_subtree_size, count / static_cast<std::uint32_t>(4 * (jobs->ThreadCount() + 1)));
+		std::vector<Node> top;
+		std::vector<Subtree> subtrees;
+		BuildNode(top, items, 0, count, 0, &subtrees, subtree_size);
+		jobs->ParallelFor(0, subtrees.size(), [&](size_t i) {
+			Subtree& subtree = subtrees[i];
+			subtree.nodes.reserve(2 * (subtree.end - subtree.begin) / s_max_leaf_size + 1);
+			BuildNode(subtree.nodes, items, subtree.begin, subtree.end, subtree.depth);
+			}, 1);
+		Splice(top, 0, subtrees);
+	}
+
+	m_boxes.Resize(items.size());
+	m_ids.resize(items.size());
+	std::fill(m_item_of_id.begin(), m_item_of_id.end(), s_removed);
+	for (std::uint32_t i = 0; i < items.size(); ++i)
+	{
+		unsigned int id = items[i].id;
+		m_boxes.Set(i, items[i].bb);
+		m_ids[i] = id;
+		if (id >= m_item_of_id.size())
+			m_item_of_id.resize(std::max<size_t>(id + 1, m_item_of_id.size() * 2), s_removed);
+		m_item_of_id[id] = i;
+	}
+}
+
+std::uint32_t StaticBVH::BuildNode(std::vector<Node>& nodes, std::vector<Item>& items, std::uint32_t begin, std::uint32_t end, unsigned int depth,
+	std::vector<Subtree>* subtrees, std::uint32_t subtree_size)
+{
+	auto index = static_cast<std::uint32_t>(nodes.size());
+	if (subtrees && end - begin <= subtree_size)
+	{
+		nodes.push_back({ EmptyBox(), static_cast<std::uint32_t>(subtrees->size()), s_deferred });
+		subtrees->push_back({ begin, end, depth, {} });
+		return index;
+	}
+	nodes.push_back({ EmptyBox(), begin, end - begin });
+	AABB bb = EmptyBox();
+	AABB centres = EmptyBox();
+	for (std::uint32_t i = begin; i < end; ++i)
+	{
+		Grow(bb, items[i].bb);
+		glm::vec2 centre = Centre(items[i].bb);
+		Grow(centres, { centre, centre });
+	}
+	nodes[index].bb = bb;
+
+	std::uint32_t count = end - begin;
+	if (count <= s_max_leaf_size / 2)
+		return index;
+	glm::vec2 extent = centres.max - centres.min;
+	int axis = extent.x >= extent.y ? 0 : 1;
+	if (extent[axis] <= 0.f)
+	{
+		if (count <= s_max_leaf_size)
+			return index;
+		axis = -1;
+	}
+
+	std::uint32_t middle = begin + count / 2;
+	bool median = axis < 0 || depth >= s_max_sah_depth;
+	if (!median)
+	{
+		struct Bin
+		{
+			AABB bb = EmptyBox();
+			std::uint32_t count = 0;
+		};
+		std::array<Bin, s_bin_count> bins;
+		float scale = s_bin_count / extent[axis];
+		auto bin_of = [&](const Item& item) {
+			auto bin = static_cast<unsigned int>((Centre(item.bb)[axis] - centres.min[axis]) * scale);
+			return std::min(bin, s_bin_count - 1);
+			};
+		for (std::uint32_t i = begin; i < end; ++i)
+		{
+			Bin& bin = bins[bin_of(items[i])];
+			Grow(bin.bb, items[i].bb);
+			++bin.count;
+		}
+
+		// Cost of splitting after each bin, from a right-to-left then a left-to-right sweep
+		std::array<float, s_bin_count - 1> right_cost;
+		AABB right = EmptyBox();
+		std::uint32_t right_count = 0;
+		for (unsigned int i = s_bin_count - 1; i > 0; --i)
+		{
+			Grow(right, bins[i].bb);
+			right_count += bins[i].count;
+			right_cost[i - 1] = right_count ? right_count * HalfPerimeter(right) : 0.f;
+		}
+		float best_cost = std::numeric_limits<float>::infinity();
+		unsigned int best_split = 0;
+		AABB left = EmptyBox();
+		std::uint32_t left_count = 0;
+		for (unsigned int i = 0; i + 1 < s_bin_count; ++i)
+		{
+			Grow(left, bins[i].bb);
+			left_count += bins[i].count;
+			float cost = (left_count ? left_count * HalfPerimeter(left) : 0.f) + right_cost[i];
+			if (left_count > 0 && left_count < count && cost < best_cost)
+			{
+				best_cost = cost;
+				best_split = i;
+			}
+		}
+
+		if (count <= s_max_leaf_size && best_cost >= count * HalfPerimeter(bb))
+			return index;
+		if (best_cost < std::numeric_limits<float>::infinity())
+			middle = static_cast<std::uint32_t>(std::partition(items.begin() + begin, items.begin() + end,
+				[&](const Item& item) { return bin_of(item) <= best_split; }) - items.begin());
+		else
+			median = true;
+	}
+	if (median)
+	{
+		int median_axis = axis < 0 ? 0 : axis;
+		std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+			[median_axis](const Item& a, const Item& b) { return Centre(a.bb)[median_axis] < Centre(b.bb)[median_axis]; });
+	}
+
+	nodes[index].count = 0;
+	BuildNode(nodes, items, begin, middle, depth + 1, subtrees, subtree_size);
+	std::uint32_t right_child = BuildNode(nodes, items, middle, end, depth + 1, subtrees, subtree_size);
+	nodes[index].index = right_child;
+	return index;
+}
+
+std::uint32_t StaticBVH::Splice(const std::vector<Node>& top, std::uint32_t index, const std::vector<Subtree>& subtrees)
+{
+	const Node& node = top[index];
+	auto at = static_cast<std::uint32_t>(m_nodes.size());
+	if (node.count == s_deferred)
+	{
+		// Right child indices of the subtree were relative to its own array
+		for (Node subtree_node : subtrees[node.index].nodes)
+		{
+			if (subtree_node.count == 0)
+				subtree_node.index += at;
+			m_nodes.push_back(subtree_node);
+		}
+		return at;
+	}
+	m_nodes.push_back(node);
+	if (node.count == 0)
+	{
+		Splice(top, index + 1, subtrees);
+		std::uint32_t right_child = Splice(top, node.index, subtrees);
+		m_nodes[at].index = right_child;
+	}
+	return at;
+}
+
+void StaticBVH::Remove(unsigned int id)
+{
+	if (id >= m_item_of_id.size() || m_item_of_id[id] == s_removed)
+		return;
+	m_ids[m_item_of_id[id]] = s_removed;
+	m_item_of_id[id] = s_removed;
+	++m_removed;
+}
@@ -0,0 +1,249 @@
+#include "collider_manager/sweep_and_prune.hpp"
+
+SweepAndPrune::SweepAndPrune(glm::vec2 pos, float width) :
+	m_pos(pos),
+	m_width(width)
+{}
+
+void SweepAndPrune::AddPair(unsigned int a, unsigned int b)
+{
+	m_overlaps[a].push_back(b);
+	m_overlaps[b].push_back(a);
+}
+
+void SweepAndPrune::RemovePair(unsigned int a, unsigned int b)
+{
+	auto erase = [](std::vector<unsigned int>& ids, unsigned int id) {
+		auto it = std::find(ids.begin(), ids.end(), id);
+		if (it == ids.end())
+			return false;
+		*it = ids.back();
+		ids.pop_back();
+		return true;
+		};
+	if (erase(m_overlaps[a], b))
+		erase(m_overlaps[b], a);
+}
+
+void SweepAndPrune::RemovePairs(unsigned int id)
+{
+	for (auto other : m_overlaps[id])
+	{
+		auto& ids = m_overlaps[other];
+		auto it = std::find(ids.begin(), ids.end(), id);
+		*it = ids.back();
+		ids.pop_back();
+	}
+	m_overlaps[id].clear();
+}
+
+void SweepAndPrune::Swap(int axis, std::uint32_t position)
+{
+	// Swaps the endpoints at position and position + 1, the first one moves right
+	auto& endpoints = m_axes[axis];
+	Endpoint right_moving = endpoints[position];
+	Endpoint left_moving = endpoints[position + 1];
+	std::swap(endpoints[position], endpoints[position + 1]);
+	Box& a = m_boxes[right_moving.Slot()];
+	Box& b = m_boxes[left_moving.Slot()];
+	a.endpoints[axis][right_moving.IsMax()] = position + 1;
+	b.endpoints[axis][left_moving.IsMax()] = position;
+
+	if (right_moving.IsMax() == left_moving.IsMax() || !a.alive || !b.alive)
+		return;
+	// A max passing a min to the right starts an overlap on this axis, a min passing a max ends one
+	if (right_moving.IsMax())
+	{
+		if (Overlap(a, b))
+			AddPair(a.id, b.id);
+	}
+	else
+		RemovePair(a.id, b.id);
+}
+
+void SweepAndPrune::Sift(int axis, std::uint32_t position)
+{
+	auto& endpoints = m_axes[axis];
+	float value = endpoints[position].value;
+	while (position > 0 && endpoints[position - 1].value > value)
+		Swap(axis, --position);
+	while (position + 1 < endpoints.size() && endpoints[position + 1].value < value)
+		Swap(axis, position++);
+}
+
+void SweepAndPrune::MoveEndpoints(std::uint32_t slot, int axis)
+{
+	Box& box = m_boxes[slot];
+	auto& endpoints = m_axes[axis];
+	// Move the leading endpoint first so the box never turns inside out
+	bool towards_max = box.bb.min[axis] > endpoints[box.endpoints[axis][0]].value;
+	for (bool is_max : { towards_max, !towards_max })
+	{
+		std::uint32_t position = m_boxes[slot].endpoints[axis][is_max];
+		endpoints[position].value = Bound(m_boxes[slot].bb, axis, is_max);
+		Sift(axis, position);
+	}
+}
+
+void SweepAndPrune::Reindex(int axis)
+{
+	const auto& endpoints = m_axes[axis];
+	for (std::uint32_t position = 0; position < endpoints.size(); ++position)
+		m_boxes[endpoints[position].Slot()].endpoints[axis][endpoints[position].IsMax()] = position;
+}
+
+void SweepAndPrune::FindNewPairs()
+{
+	// One sweep along x: a new box is tested against every open box, an old one against open
+	// new boxes only, so pairs of old boxes are not reported again
+	std::vector<std::uint32_t> active_old, active_new;
+	std::vector<std::uint32_t> active_index(m_boxes.size());
+	std::vector<bool> is_new(m_boxes.size());
+	for (auto slot : m_pending)
+		is_new[slot] = true;
+
+	auto test = [this](std::uint32_t slot, const std::vector<std::uint32_t>& active) {
+		const Box& box = m_boxes[slot];
+		for (auto other : active)
+			if (Overlap(box, m_boxes[other]))
+				AddPair(box.id, m_boxes[other].id);
+		};
+	for (const auto& endpoint : m_axes[0])
+	{
+		std::uint32_t slot = endpoint.Slot();
+		auto& active = is_new[slot] ? active_new : active_old;
+		if (endpoint.IsMax())
+		{
+			std::uint32_t last = active.back();
+			active[active_index[slot]] = last;
+			active_index[last] = active_index[slot];
+			active.pop_back();
+			continue;
+		}
+		if (is_new[slot])
+			test(slot, active_old);
+		test(slot, active_new);
+		active_index[slot] = static_cast<std::uint32_t>(active.size());
+		active.push_back(slot);
+	}
+}
+
+void SweepAndPrune::Insert(unsigned int id, const AABB& bb)
+{
+	ENGINE_PROFILE_SCOPE("SweepAndPrune::Insert");
+	if (!Contains(bb) || SlotOf(id) != s_invalid)
+		return;
+	std::uint32_t slot;
+	if (!m_free_slots.empty())
+	{
+		slot = m_free_slots.back();
+		m_free_slots.pop_back();
+	}
+	else
+	{
+		slot = static_cast<std::uint32_t>(m_boxes.size());
+		m_boxes.emplace_back();
+	}
+	m_boxes[slot] = { bb, id, {}, true, false };
+	if (id >= m_slot_of_id.size())
+	{
+		m_slot_of_id.resize(std::max<size_t>(id + 1, m_slot_of_id.size() * 2), s_invalid);
+		m_overlaps.resize(m_slot_of_id.size());
+	}
+	m_slot_of_id[id] = slot;
+	m_pending.push_back(slot);
+	m_max_extent = std::max(m_max_extent, bb.max.x - bb.min.x);
+	++m_size;
+}
+
+void SweepAndPrune::Delete(unsigned int id, const AABB&)
+{
+	ENGINE_PROFILE_SCOPE("SweepAndPrune::Delete");
+	std::uint32_t slot = SlotOf(id);
+	if (slot == s_invalid)
+		return;
+	RemovePairs(id);
+	m_boxes[slot].alive = false;
+	m_slot_of_id[id] = s_invalid;
+	++m_dead;
+	--m_size;
+}
+
+void SweepAndPrune::Update(unsigned int id, const AABB& old_bb, const AABB& new_bb)
+{
+	std::uint32_t slot = SlotOf(id);
+	if (slot == s_invalid)
+	{
+		Insert(id, new_bb);
+		return;
+	}
+	if (!Contains(new_bb))
+	{
+		Delete(id, old_bb);
+		return;
+	}
+	m_boxes[slot].bb = new_bb;
+	m_max_extent = std::max(m_max_extent, new_bb.max.x - new_bb.min.x);
+	if (!m_boxes[slot].sorted)
+		return;
+	MoveEndpoints(slot, 0);
+	MoveEndpoints(slot, 1);
+}
+
+void SweepAndPrune::Flush()
+{
+	if (m_dead == 0 && m_pending.empty())
+		return;
+	ENGINE_PROFILE_SCOPE("SweepAndPrune::Flush");
+
+	if (m_dead > 0)
+	{
+		for (auto& endpoints : m_axes)
+			std::erase_if(endpoints, [this](const Endpoint& e) { return !m_boxes[e.Slot()].alive; });
+		std::erase_if(m_pending, [this](std::uint32_t slot) { return !m_boxes[slot].alive; });
+		m_max_extent = 0.f;
+		for (std::uint32_t slot = 0; slot < m_boxes.size(); ++slot)
+		{
+			if (m_boxes[slot].alive)
+				m_max_extent = std::max(m_max_extent, m_boxes[slot].bb.max.x - m_boxes[slot].bb.min.x);
+			else if (m_boxes[slot].sorted || m_boxes[slot].id != s_invalid)
+			{
+				m_boxes[slot].sorted = false;
+				m_boxes[slot].id = s_invalid;
+				m_free_slots.push_back(slot);
+			}
+		}
+		m_dead = 0;
+	}
+
+	if (!m_pending.empty())
+	{
+		for (int axis = 0; axis < 2; ++axis)
+		{
+			std::vector<Endpoint> added;
+			added.reserve(2 * m_pending.size());
+			for (auto slot : m_pending)
+			{
+				added.push_back({ m_boxes[slot].bb.min[axis], slot << 1 });
+				added.push_back({ m_boxes[slot].bb.max[axis], slot << 1 | 1 });
+			}
+			// Mins first on ties, so touching boxes overlap like everywhere else
+			auto less = [](const Endpoint& a, const Endpoint& b) { return a.value < b.value || (a.value == b.value && a.IsMax() < b.IsMax()); };
+			std::sort(added.begin(), added.end(), less);
+			auto& endpoints = m_axes[axis];
+			size_t middle = endpoints.size();
+			endpoints.insert(endpoints.end(), added.begin(), added.end());
+			std::inplace_merge(endpoints.begin(), endpoints.begin() + middle, endpoints.end(), less);
+		}
+	}
+	Reindex(0);
+	Reindex(1);
+
+	if (!m_pending.empty())
+	{
+		FindNewPairs();
+		for (auto slot : m_pending)
+			m_boxes[slot].sorted = true;
+		m_pending.clear();
+	}
+}
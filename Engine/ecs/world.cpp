@@ -0,0 +1,87 @@
+#include "ecs/world.hpp"
+
+std::uint32_t World::AddArchetype(std::vector<ComponentId> signature, std::vector<std::unique_ptr<IComponentColumn>> columns)
+{
+	auto index = static_cast<std::uint32_t>(m_archetypes.size());
+	m_archetype_lookup.emplace(signature, index);
+	m_archetypes.push_back(std::make_unique<Archetype>(std::move(signature), std::move(columns)));
+	return index;
+}
+
+Entity World::AllocateEntity()
+{
+	std::uint32_t index;
+	if (!m_free_indices.empty())
+	{
+		index = m_free_indices.back();
+		m_free_indices.pop_back();
+	}
+	else
+	{
+		if (m_records.size() > Entity::s_index_mask)
+			throw ECSEntityLimitException();
+		index = static_cast<std::uint32_t>(m_records.size());
+		m_records.emplace_back();
+	}
+	Record& record = m_records[index];
+	record.alive = true;
+	++m_alive;
+	return Entity{ (record.generation << Entity::s_index_bits) | index };
+}
+
+const World::Record& World::GetRecord(Entity entity) const
+{
+	if (!IsAlive(entity))
+		throw ECSDeadEntityException();
+	return m_records[entity.Index()];
+}
+
+void World::RemoveRow(std::uint32_t archetype_index, std::uint32_t row)
+{
+	auto& entities = m_archetypes[archetype_index]->Entities();
+	if (row + 1 != entities.size())
+	{
+		entities[row] = entities.back();
+		m_records[entities[row].Index()].row = row;
+	}
+	entities.pop_back();
+}
+
+std::uint32_t World::MoveEntity(Entity entity, std::uint32_t target_index)
+{
+	Record& record = m_records[entity.Index()];
+	Archetype& source = *m_archetypes[record.archetype];
+	Archetype& target = *m_archetypes[target_index];
+
+	const auto& signature = source.Signature();
+	for (size_t i = 0; i < signature.size(); ++i)
+	{
+		int column = target.ColumnIndex(signature[i]);
+		if (column >= 0)
+			source.Column(i).MoveRowTo(record.row, target.Column(column));
+		else
+			source.Column(i).SwapRemove(record.row);
+	}
+	RemoveRow(record.archetype, record.row);
+
+	target.Entities().push_back(entity);
+	record.archetype = target_index;
+	record.row = static_cast<std::uint32_t>(target.Size() - 1);
+	return record.row;
+}
+
+void World::Destroy(Entity entity)
+{
+	if (!IsAlive(entity))
+		return;
+	Record& record = m_records[entity.Index()];
+	Archetype& archetype = *m_archetypes[record.archetype];
+	for (size_t i = 0; i < archetype.Signature().size(); ++i)
+		archetype.Column(i).SwapRemove(record.row);
+	RemoveRow(record.archetype, record.row);
+
+	record.alive = false;
+	record.generation = (record.generation + 1) & Entity::s_generation_mask;
+	m_free_indices.push_back(entity.Index());
+	--m_alive;
+}
@@ -1,2 +1,18 @@
 #include "engine.hpp"
 
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#include <cstdlib>
+#include <memory>
+#endif
+
+std::string ReadableTypeName(const std::type_info& type)
+{
+#if defined(__GNUG__)
+	int status = 0;
+	std::unique_ptr<char, decltype(&std::free)> demangled(abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), &std::free);
+	if (status == 0 && demangled)
+		return demangled.get();
+#endif
+	return type.name();
+}
@@ -1,5 +1,8 @@
 #include "graphic_manager/fps_counter_renderer.hpp"
 
+#include <array>
+#include <charconv>
+
 FPSCounterRenderer::FPSCounterRenderer()
 {
 	program = std::make_unique<GLProgram>(
@@ -61,22 +64,25 @@ FPSCounterRenderer::FPSCounterRenderer()
 
 void FPSCounterRenderer::Render(float fps_f, float x, float y, float scale)
 {
-	std::ostringstream oss;
-	oss << std::fixed << std::setprecision(1) << fps_f;
-	std::string fps = oss.str();
+	// Formatted on the stack, this runs every frame
+	char fps[32];
+	auto [end, ec] = std::to_chars(fps, fps + sizeof(fps), fps_f, std::chars_format::fixed, 1);
+	if (ec != std::errc())
+		end = fps;
 
-	std::vector<int> chars = { F, P, S, Colon, Empty };
-	for (int i = 0; i < fps.size(); ++i)
-		if (fps[i] == '.')
-			chars.push_back(Point);
-		else
-			chars.push_back(fps[i] - '0');
+	std::array<int, 5 + sizeof(fps)> chars = { F, P, S, Colon, Empty };
+	size_t count = 5;
+	for (const char* c = fps; c != end; ++c)
+		if (*c == '.')
+			chars[count++] = Point;
+		else if (*c >= '0' && *c <= '9')
+			chars[count++] = *c - '0';
 
-	for (int i = 0; i < chars.size(); ++i)
+	for (size_t i = 0; i < count; ++i)
 	{
 		Character& ch = m_charachers[chars[i]];
 
-		std::unique_ptr<IUniform> transform = std::make_unique<GLUniform<glm::mat3>>(
+		GLUniform<glm::mat3> transform(
 			glm::translate(glm::mat3(1.f), glm::vec2(x, y))
 			* glm::scale(glm::mat3(1.f), glm::vec2(scale))
 			* glm::translate(glm::mat3(1.f), glm::vec2(ch.Bearing.x, ch.Bearing.y - ch.Size.y))
@@ -85,7 +91,7 @@ void FPSCounterRenderer::Render(float fps_f, float x, float y, float scale)
 
 
 		program->Bind();
-		program->SetUniform(transform.get(), "transformation");
+		program->SetUniform(&transform, "transformation");
 		mesh->Bind();
 		ch.Texture.BindTextureToUnit();
 		glDrawElements(GL_TRIANGLES,
@@ -1,4 +1,5 @@
 #include "graphic_manager/graphic_manager.hpp"
+#include "profiler/profiler.hpp"
 
 GLGraphicManager::GLGraphicManager(int init_width, int init_height)
 {
@@ -33,6 +34,29 @@ GLGraphicManager::GLGraphicManager(int init_width, int init_height)
 
 bool GLGraphicManager::Update(float time)
 {
+	ENGINE_PROFILE_SCOPE("GLGraphicManager::Update");
+	// Only the hand-off happens under the lock, so a slow frame never blocks the managers queueing uploads
+	std::unordered_map<int, std::unique_ptr<IBufferAdapter>> pending_instance_transformations;
+	std::vector<std::pair<int, std::shared_ptr<InstanceSnapshotBuffer>>> instance_snapshots;
+	{
+		std::lock_guard lock(m_mutex);
+		pending_instance_transformations = std::move(m_pending_instance_transformations);
+		m_pending_instance_transformations.clear();
+		instance_snapshots.assign(m_instance_snapshots.begin(), m_instance_snapshots.end());
+	}
+
+	for (auto& [graphic_entity_id, transformations] : pending_instance_transformations)
+		m_graphic_entities_instanced[graphic_entity_id]->SetTransformInstances(std::move(transformations));
+
+	for (auto& [graphic_entity_id, snapshots] : instance_snapshots)
+	{
+		snapshots->Acquire();
+		snapshots->Interpolate(time, m_interpolated_instances);
+		auto entity = m_graphic_entities_instanced[graphic_entity_id].get();
+		entity->GetMesh();
+		entity->SetTransformInstances(std::make_unique<BufferView<glm::mat3>>(m_interpolated_instances));
+	}
+
 	glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
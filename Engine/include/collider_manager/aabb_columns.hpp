@@ -0,0 +1,98 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <bit>
+
+#include "collider_handlers.hpp"
+#include "simd.hpp"
+
+// Candidate pair of a batched query: index of the query box and id of an overlapping item
+struct BroadphasePair
+{
+	std::uint32_t query;
+	unsigned int id;
+};
+
+// Boxes stored as four parallel arrays, tested against a box several at a time with AVX2 or
+// SSE2 when the compiler targets them. The arrays are padded so a batch starting at any index
+// below Size() can be loaded whole; results past the end are masked off.
+class AABBColumns
+{
+public:
+	static constexpr std::uint32_t s_batch_width = simd_width;
+private:
+	std::vector<float> m_min_x, m_min_y, m_max_x, m_max_y;
+	size_t m_size = 0;
+public:
+	size_t Size() const noexcept
+	{
+		return m_size;
+	}
+	size_t Capacity() const noexcept
+	{
+		return m_min_x.capacity();
+	}
+	void Resize(size_t size)
+	{
+		m_size = size;
+		for (auto* column : { &m_min_x, &m_min_y, &m_max_x, &m_max_y })
+			column->resize(size + s_batch_width - 1);
+	}
+	void Reserve(size_t size)
+	{
+		for (auto* column : { &m_min_x, &m_min_y, &m_max_x, &m_max_y })
+			column->reserve(size + s_batch_width - 1);
+	}
+	void Set(size_t index, const AABB& bb)
+	{
+		m_min_x[index] = bb.min.x;
+		m_min_y[index] = bb.min.y;
+		m_max_x[index] = bb.max.x;
+		m_max_y[index] = bb.max.y;
+	}
+	AABB Get(size_t index) const
+	{
+		return { { m_max_x[index], m_max_y[index] }, { m_min_x[index], m_min_y[index] } };
+	}
+
+	// Bit i set when box first + i overlaps bb, same test as intersects()
+	unsigned int OverlapMask(std::uint32_t first, const AABB& bb) const
+	{
+#if defined(ENGINE_SIMD_AVX2)
+		__m256 overlap_x = _mm256_and_ps(
+			_mm256_cmp_ps(_mm256_loadu_ps(&m_max_x[first]), _mm256_set1_ps(bb.min.x), _CMP_GT_OQ),
+			_mm256_cmp_ps(_mm256_loadu_ps(&m_min_x[first]), _mm256_set1_ps(bb.max.x), _CMP_LT_OQ));
+		__m256 overlap_y = _mm256_and_ps(
+			_mm256_cmp_ps(_mm256_loadu_ps(&m_max_y[first]), _mm256_set1_ps(bb.min.y), _CMP_GT_OQ),
+			_mm256_cmp_ps(_mm256_loadu_ps(&m_min_y[first]), _mm256_set1_ps(bb.max.y), _CMP_LT_OQ));
+		return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_and_ps(overlap_x, overlap_y)));
+#elif defined(ENGINE_SIMD_SSE2)
+		__m128 overlap_x = _mm_and_ps(
+			_mm_cmpgt_ps(_mm_loadu_ps(&m_max_x[first]), _mm_set1_ps(bb.min.x)),
+			_mm_cmplt_ps(_mm_loadu_ps(&m_min_x[first]), _mm_set1_ps(bb.max.x)));
+		__m128 overlap_y = _mm_and_ps(
+			_mm_cmpgt_ps(_mm_loadu_ps(&m_max_y[first]), _mm_set1_ps(bb.min.y)),
+			_mm_cmplt_ps(_mm_loadu_ps(&m_min_y[first]), _mm_set1_ps(bb.max.y)));
+		return static_cast<unsigned int>(_mm_movemask_ps(_mm_and_ps(overlap_x, overlap_y)));
+#else
+		return m_max_x[first] > bb.min.x && bb.max.x > m_min_x[first] && m_max_y[first] > bb.min.y && bb.max.y > m_min_y[first];
+#endif
+	}
+
+	// Calls f(index) for every box in [begin, end) overlapping bb, in index order
+	template <typename F>
+	void ForEachOverlapping(std::uint32_t begin, std::uint32_t end, const AABB& bb, F&& f) const
+	{
+		for (std::uint32_t first = begin; first < end; first += s_batch_width)
+		{
+			unsigned int mask = OverlapMask(first, bb);
+			if (end - first < s_batch_width)
+				mask &= (1u << (end - first)) - 1;
+			while (mask)
+			{
+				f(first + static_cast<std::uint32_t>(std::countr_zero(mask)));
+				mask &= mask - 1;
+			}
+		}
+	}
+};
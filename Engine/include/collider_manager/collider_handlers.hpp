@@ -1,7 +1,8 @@
 #pragma once
 #include <glm/glm.hpp>
 
-#include <functional>
+#include <optional>
+#include <algorithm>
 
 struct Rect
 {
@@ -28,21 +29,48 @@ struct CircleRectCollideInfo
 };
 
 
+// First contact of a moving circle: fraction of the motion travelled and, like
+// CircleRectCollideInfo::normal_collision, the unnormalized direction from the rect to the circle
+struct SweepHit
+{
+	float time;
+	glm::vec2 normal;
+};
+
+// Circle moving by motion against the same capsule ColliderCircle::Test uses (the rect's axis
+// widened by circle radius + rect height). Circles already overlapping the rect give no hit.
+std::optional<SweepHit> SweepCircleRect(const Circle& circle, glm::vec2 motion, const Rect& rect);
+// Same for a circle target; a ray is a circle of radius 0
+std::optional<SweepHit> SweepCircleCircle(const Circle& circle, glm::vec2 motion, const Circle& target);
+// Distance from point to the shape, 0 inside it; the rect is the same capsule as above
+float Distance(glm::vec2 point, const Rect& rect);
+float Distance(glm::vec2 point, const Circle& circle);
+
 class ColliderRect;
 class ColliderCircle;
 
+// Concrete type behind an IColliderAABB; indexes the collider pools and the pair table
+enum class ColliderShape
+{
+	Circle,
+	Rect,
+	Count
+};
+
 struct IColliderAABB
 {
+	virtual ColliderShape GetShape() const = 0;
 	virtual const AABB& GetBoundingBox() = 0;
 	virtual void Transform(const glm::mat3& transformation) = 0;
-	virtual void Test(const IColliderAABB* collider) const = 0;
-	virtual void Test(const ColliderRect* collider) const = 0;
-	virtual void Test(const ColliderCircle* collider) const = 0;
+	// Contact with another collider, if any; the manager tests circle/rect pairs in batches instead
+	virtual std::optional<CircleRectCollideInfo> Test(const IColliderAABB* collider) const = 0;
+	virtual std::optional<CircleRectCollideInfo> Test(const ColliderRect* collider) const = 0;
+	virtual std::optional<CircleRectCollideInfo> Test(const ColliderCircle* collider) const = 0;
 	virtual unsigned int GetId() const = 0;
 	virtual ~IColliderAABB() = 0 {};
 };
 
-class ColliderRect : public IColliderAABB
+class ColliderRect final : public IColliderAABB
 {
 	friend ColliderCircle;
 private:
@@ -50,33 +78,31 @@ private:
 	AABB m_AABB;
 	unsigned int m_id;
 
+	// Bounds the capsule GetNormalCollision tests: the axis widened by the full height
 	void UpdateAABB()
 	{
-		glm::vec2 v = m_rect.end - m_rect.start;
-		glm::vec2 n = m_rect.height / 2.f * glm::normalize(glm::vec2(-v.y, v.x));
-
-		glm::vec2 quadrangle[4] = { m_rect.end - n, m_rect.end + n, m_rect.start - n, m_rect.start + n };
-
-		m_AABB.max = glm::vec2(
-			std::max(std::max(quadrangle[0].x, quadrangle[1].x), std::max(quadrangle[2].x, quadrangle[3].x)),
-			std::max(std::max(quadrangle[0].y, quadrangle[1].y), std::max(quadrangle[2].y, quadrangle[3].y))
-		);
-		m_AABB.min = glm::vec2(
-			std::min(std::min(quadrangle[0].x, quadrangle[1].x), std::min(quadrangle[2].x, quadrangle[3].x)),
-			std::min(std::min(quadrangle[0].y, quadrangle[1].y), std::min(quadrangle[2].y, quadrangle[3].y))
-		);
+		m_AABB.max = glm::max(m_rect.start, m_rect.end) + glm::vec2(m_rect.height);
+		m_AABB.min = glm::min(m_rect.start, m_rect.end) - glm::vec2(m_rect.height);
 	}
 	
 public:
 	ColliderRect(const Rect& rect, unsigned int id) : m_rect(rect), m_id(id){ UpdateAABB(); }
 
+	ColliderShape GetShape() const override
+	{
+		return ColliderShape::Rect;
+	}
 	unsigned int GetId() const override
 	{
 		return m_id;
 	}
-	void Test(const IColliderAABB* collider) const override
+	const Rect& GetRect() const
+	{
+		return m_rect;
+	}
+	std::optional<CircleRectCollideInfo> Test(const IColliderAABB* collider) const override
 	{
-		collider->Test(this);
+		return collider->Test(this);
 	}
 	void Transform(const glm::mat3& transformation) override
 	{
@@ -84,16 +110,18 @@ public:
 		m_rect.end = transformation * glm::vec3(m_rect.end, 1.f);
 		UpdateAABB();
 	}
-	void Test(const ColliderRect* collider) const override
-	{}
-	void Test(const ColliderCircle* collider) const override;
+	std::optional<CircleRectCollideInfo> Test(const ColliderRect* collider) const override
+	{
+		return {};
+	}
+	std::optional<CircleRectCollideInfo> Test(const ColliderCircle* collider) const override;
 	const AABB& GetBoundingBox() override
 	{
 		return m_AABB;
 	}
 };
 
-class ColliderCircle : public IColliderAABB
+class ColliderCircle final : public IColliderAABB
 {
 	friend ColliderRect;
 private:
@@ -106,32 +134,36 @@ private:
 		m_AABB.max = glm::vec2(m_circle.pos.x + m_circle.radius, m_circle.pos.y + m_circle.radius);
 		m_AABB.min = glm::vec2(m_circle.pos.x - m_circle.radius, m_circle.pos.y - m_circle.radius);
 	}
-	static std::vector<std::function<void(CircleRectCollideInfo)>> s_callbacks_circle_rect_collider;
 public:
 	ColliderCircle(const Circle& circle, unsigned int id) : m_id(id), m_circle(circle) { UpdateAABB(); }
 
+	ColliderShape GetShape() const override
+	{
+		return ColliderShape::Circle;
+	}
 	unsigned int GetId() const override
 	{
 		return m_id;
 	}
-
-	static void OnCollideAll(std::function<void(CircleRectCollideInfo)>&& callback)
+	const Circle& GetCircle() const
 	{
-		s_callbacks_circle_rect_collider.push_back(std::move(callback));
+		return m_circle;
 	}
 
-	void Test(const IColliderAABB* collider) const override
+	std::optional<CircleRectCollideInfo> Test(const IColliderAABB* collider) const override
 	{
-		collider->Test(this);
+		return collider->Test(this);
 	}
 	void Transform(const glm::mat3& transformation) override
 	{
 		m_circle.pos = transformation * glm::vec3(m_circle.pos, 1.f);
 		UpdateAABB();
 	}
-	void Test(const ColliderRect* collider) const override;
-	void Test(const ColliderCircle* collider) const override
-	{}
+	std::optional<CircleRectCollideInfo> Test(const ColliderRect* collider) const override;
+	std::optional<CircleRectCollideInfo> Test(const ColliderCircle* collider) const override
+	{
+		return {};
+	}
 	const AABB& GetBoundingBox() override
 	{
 		return m_AABB;
@@ -1,25 +1,263 @@
 #pragma once
 #include "collider_handlers.hpp"
 #include "quadtree.hpp"
+#include "linear_quadtree.hpp"
+#include "spatial_hash.hpp"
+#include "sweep_and_prune.hpp"
+#include "static_bvh.hpp"
+#include "narrowphase.hpp"
+#include "collider_pool.hpp"
+#include "engine_context.hpp"
 
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
+#include <array>
+#include <functional>
+#include <span>
+#include <concepts>
+#include <type_traits>
 
-class ColliderBBManager final
+// Structure that finds the colliders whose boxes overlap a box; ids are collider ids
+template <typename T>
+concept Broadphase = requires(T broadphase, const T const_broadphase, unsigned int id, const AABB& bb, std::vector<unsigned int>& result)
+{
+	broadphase.Insert(id, bb);
+	broadphase.Delete(id, bb);
+	broadphase.Update(id, bb, bb);
+	const_broadphase.GetIntersection(bb, result);
+};
+
+// Static colliders are not expected to move; they are kept out of the broadphase in a BVH
+// that is rebuilt only when static colliders were added or moved, or many were deleted
+enum class ColliderMobility
+{
+	Dynamic,
+	Static
+};
+
+// Bit mask set per collider; a subscriber receives the contacts in which either collider
+// shares a bit with its filter
+using ColliderCategory = std::uint32_t;
+// Circle moving by motion, against colliders sharing a bit with categories; radius 0 for a ray
+struct CircleCast
+{
+	Circle circle;
+	glm::vec2 motion;
+	ColliderCategory categories = ~ColliderCategory(0);
+};
+// Collider hit first by a cast, time is the fraction of the motion travelled
+struct CircleCastHit
+{
+	float time;
+	glm::vec2 normal;
+	unsigned int collider_id;
+};
+// Result of a nearest or radius query, distance from the point to the collider's shape
+struct ColliderDistance
+{
+	float distance;
+	unsigned int collider_id;
+};
+
+// Called once per frame with every contact of the frame that passed the subscriber's filter
+using ContactCallback = std::function<void(std::span<const CircleRectCollideInfo>)>;
+
+template <Broadphase TBroadphase>
+class BasicColliderBBManager final
 {
 private:
-	std::unordered_map<int, std::unique_ptr<IColliderAABB>> m_colliders;
-	Quadtree quadtree;
+	struct ColliderSlot
+	{
+		ColliderShape shape;
+		// Entry in the pool of the shape, s_no_slot once deleted
+		std::uint32_t index;
+	};
+	static constexpr std::uint32_t s_no_slot = static_cast<std::uint32_t>(-1);
+
+	ColliderPool<ColliderCircle> m_circles;
+	ColliderPool<ColliderRect> m_rects;
+	// Indexed by collider id; ids of deleted colliders are reused
+	std::vector<ColliderSlot> m_slots;
+	std::vector<ColliderMobility> m_mobility;
+	std::vector<ColliderCategory> m_category;
+	std::vector<unsigned int> m_free_ids;
+	// Dynamic colliders only
+	TBroadphase m_broadphase;
+	StaticBVH m_static_tree;
+	size_t m_static_count = 0;
+	// Categories of every dynamic collider added so far and of the static tree's colliders; queries
+	// for other categories skip the broadphase or the tree
+	ColliderCategory m_dynamic_categories = 0;
+	ColliderCategory m_static_categories = 0;
+	bool m_static_tree_dirty = false;
+
+	// Dynamic colliders moved since the last flush, with the box the broadphase still holds;
+	// collider_id is s_no_slot once the collider was deleted
+	struct PendingMove
+	{
+		unsigned int collider_id;
+		AABB indexed_bb;
+	};
+	std::vector<PendingMove> m_pending_moves;
+	// Indexed by collider id: entry in m_pending_moves, s_no_slot if it has not moved
+	std::vector<std::uint32_t> m_pending_move_of;
+
+	// Deduplicated in Update; vectors swapped each frame so their capacity is reused
+	std::vector<unsigned int> m_changedCollider;
+	std::vector<unsigned int> m_testedCollider;
+	// Tested colliders handed to one job at a time
+	static constexpr size_t s_chunk_size = 256;
+	CircleRectBatch m_circle_rect_pairs;
+	std::unique_ptr<PerWorker<CircleRectBatch>> m_narrowphase;
+	FrameArena* m_frame_arena = nullptr;
+	JobSystem* m_jobs = nullptr;
 
-	std::unordered_set<int> m_changedCollider;
-	unsigned int m_counter = 0;
+	struct Subscription
+	{
+		unsigned int id;
+		ColliderCategory categories;
+		ContactCallback callback;
+	};
+	std::vector<Subscription> m_subscriptions;
+	unsigned int m_next_subscription = 0;
+	// Contacts from ReportContact, dispatched with the next Update's
+	std::vector<CircleRectCollideInfo> m_reported;
+	std::vector<ColliderCategory> m_reported_categories;
+
+	// Adds a circle/rect pair to the batch; one entry per ordered pair of shapes, null for
+	// pairs without a response
+	using PairCollector = void (*)(const BasicColliderBBManager& manager, unsigned int col_indexA, unsigned int col_indexB, CircleRectBatch& batch);
+	static constexpr size_t s_shape_count = static_cast<size_t>(ColliderShape::Count);
+	static const std::array<std::array<PairCollector, s_shape_count>, s_shape_count> s_pair_collectors;
+	static void CollectCircleRect(const BasicColliderBBManager& manager, unsigned int circle_id, unsigned int rect_id, CircleRectBatch& batch);
+	static void CollectRectCircle(const BasicColliderBBManager& manager, unsigned int rect_id, unsigned int circle_id, CircleRectBatch& batch)
+	{
+		CollectCircleRect(manager, circle_id, rect_id, batch);
+	}
+	// Sweep of a moving circle against the pool entry, one per target shape
+	using SweepTest = std::optional<SweepHit> (*)(const BasicColliderBBManager& manager, const Circle& circle, glm::vec2 motion, std::uint32_t index);
+	static const std::array<SweepTest, s_shape_count> s_sweep_tests;
+	// Distance from a point to the pool entry, one per shape
+	using DistanceTest = float (*)(const BasicColliderBBManager& manager, glm::vec2 point, std::uint32_t index);
+	static const std::array<DistanceTest, s_shape_count> s_distance_tests;
+	// Casts handed to one job at a time
+	static constexpr size_t s_cast_chunk_size = 64;
+
+	bool IsAlive(unsigned int collider_id) const
+	{
+		return collider_id < m_slots.size() && m_slots[collider_id].index != s_no_slot;
+	}
+	// f(collider) with the collider as its concrete type
+	template <typename F>
+	decltype(auto) Visit(unsigned int collider_id, F&& f)
+	{
+		const ColliderSlot& slot = m_slots[collider_id];
+		switch (slot.shape)
+		{
+		case ColliderShape::Circle:
+			return f(m_circles[slot.index]);
+		default:
+			return f(m_rects[slot.index]);
+		}
+	}
+	template <typename TCollider>
+	unsigned int Add(ColliderPool<TCollider>& pool, ColliderShape shape, const TCollider& collider, ColliderMobility mobility, ColliderCategory category);
+	template <typename TCollider>
+	std::vector<unsigned int> AddMany(ColliderPool<TCollider>& pool, ColliderShape shape, std::span<const TCollider> colliders, ColliderMobility mobility, ColliderCategory category);
+	void RebuildStaticTree();
+	// Appends the contacts of the given colliders with everything else; only reads the
+	// broadphase and static tree, so ranges can be tested concurrently
+	void TestRange(std::span<const AABB> queries, std::span<const unsigned int> queried,
+		CircleRectBatch& batch, FrameVector<CircleRectCollideInfo>& contacts, FrameVector<ColliderCategory>& categories) const;
+	// Colliders within max_distance of point kept nearest first in found; a full buffer lowers the
+	// bound to its last entry when shrink is set. Returns how many were within the bound.
+	size_t FindNear(glm::vec2 point, float max_distance, bool shrink, std::span<ColliderDistance> found, ColliderCategory categories) const;
+	void Dispatch(std::span<const CircleRectCollideInfo> contacts, std::span<const ColliderCategory> categories);
 public:
-	ColliderBBManager(float scale) :
-		quadtree(glm::vec2(-scale), 2.f * scale)
+	// Broadphase covering [-scale, scale] on both axes
+	BasicColliderBBManager(float scale) requires std::constructible_from<TBroadphase, glm::vec2, float> :
+		m_broadphase(glm::vec2(-scale), 2.f * scale)
+	{};
+	BasicColliderBBManager(TBroadphase broadphase) :
+		m_broadphase(std::move(broadphase))
 	{};
-	unsigned int AddEntity(std::unique_ptr<IColliderAABB> collider);
+	void SetEngineContext(EngineContext& context)
+	{
+		m_frame_arena = &context.frame_arena;
+		m_jobs = &context.jobs;
+		m_narrowphase = std::make_unique<PerWorker<CircleRectBatch>>(context.jobs);
+	}
+	unsigned int AddEntity(const ColliderCircle& collider, ColliderMobility mobility = ColliderMobility::Dynamic, ColliderCategory category = 1);
+	unsigned int AddEntity(const ColliderRect& collider, ColliderMobility mobility = ColliderMobility::Dynamic, ColliderCategory category = 1);
+	// Copies the collider into the pool of its shape
+	unsigned int AddEntity(std::unique_ptr<IColliderAABB> collider, ColliderMobility mobility = ColliderMobility::Dynamic, ColliderCategory category = 1);
+	// Ids of colliders[i] in order. Storage is grown once for the batch; static colliders go into
+	// the tree in the single parallel build of the next Flush.
+	std::vector<unsigned int> AddEntities(std::span<const ColliderCircle> colliders, ColliderMobility mobility = ColliderMobility::Dynamic, ColliderCategory category = 1);
+	std::vector<unsigned int> AddEntities(std::span<const ColliderRect> colliders, ColliderMobility mobility = ColliderMobility::Dynamic, ColliderCategory category = 1);
+	// The collider moves at once; for a dynamic one the broadphase is updated in FlushTransforms,
+	// once however many times it moved
 	void TransformEntity(unsigned int collider_id, const glm::mat3& transformation);
+	// Applies the pending moves to the broadphase. Casts and queries before it still look moved
+	// dynamic colliders up by their old box.
+	void FlushTransforms();
+	// FlushTransforms, then rebuilds the static tree if static colliders were added, moved or
+	// removed; Update starts with it. Managers casting before the collider manager's Update call
+	// it first, otherwise static colliders added since the last frame are not hit.
+	void Flush();
 	void DeleteEntity(unsigned int collider_id);
 	bool Update(float time);
-};
\ No newline at end of file
+
+	// First collider sharing a bit with categories that the circle touches while moving by motion.
+	// The static tree and broadphase are walked front to back along the motion and stop at the
+	// first hit. Colliders the circle already overlaps are not hit. Read-only, so casts may run
+	// concurrently with each other but not with changes to the manager.
+	std::optional<CircleCastHit> CastCircle(const Circle& circle, glm::vec2 motion, ColliderCategory categories = ~ColliderCategory(0)) const;
+	// hits[i] for casts[i], in parallel chunks once an engine context is attached
+	void CastCircles(std::span<const CircleCast> casts, std::span<std::optional<CircleCastHit>> hits) const;
+	// The nearest.size() colliders sharing a bit with categories nearest to point, nearest first;
+	// returns how many were written, fewer when there are not enough colliders
+	size_t FindNearest(glm::vec2 point, std::span<ColliderDistance> nearest, ColliderCategory categories = ~ColliderCategory(0)) const;
+	// Colliders within radius of point, nearest first. Returns how many there are, of which only the
+	// nearest within.size() are written.
+	size_t FindWithinRadius(glm::vec2 point, float radius, std::span<ColliderDistance> within, ColliderCategory categories = ~ColliderCategory(0)) const;
+	// Contact found by the caller, e.g. a cast it already responded to. It is dispatched with the
+	// next Update's contacts to the subscribers of the rect's categories only.
+	void ReportContact(unsigned int circle_collider_id, unsigned int rect_collider_id, glm::vec2 normal);
+
+	// Returns an id for Unsubscribe; neither may be called from inside a callback
+	unsigned int Subscribe(ColliderCategory categories, ContactCallback callback);
+	void Unsubscribe(unsigned int subscription);
+
+	const TBroadphase& GetBroadphase() const
+	{
+		return m_broadphase;
+	}
+};
+
+extern template class BasicColliderBBManager<Quadtree>;
+extern template class BasicColliderBBManager<LinearQuadtree>;
+extern template class BasicColliderBBManager<SpatialHash>;
+extern template class BasicColliderBBManager<SweepAndPrune>;
+
+using ColliderBBManager = BasicColliderBBManager<LinearQuadtree>;
+
+template <typename T>
+struct IsColliderManager : std::false_type
+{};
+template <typename TBroadphase>
+struct IsColliderManager<BasicColliderBBManager<TBroadphase>> : std::true_type
+{};
+
+// First BasicColliderBBManager among a manager's extensions, void if there is none
+template <typename... Extensions>
+struct ColliderManagerOf
+{
+	using type = void;
+};
+template <typename T, typename... Extensions>
+struct ColliderManagerOf<T, Extensions...>
+{
+	using type = std::conditional_t<IsColliderManager<T>::value, T, typename ColliderManagerOf<Extensions...>::type>;
+};
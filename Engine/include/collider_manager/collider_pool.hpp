@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+// Colliders of one shape stored by value in one array; removal moves the last collider into
+// the freed entry, so indices are stable only until the next Remove
+template <typename TCollider>
+class ColliderPool
+{
+private:
+	std::vector<TCollider> m_colliders;
+	// Collider id of each entry
+	std::vector<unsigned int> m_ids;
+public:
+	std::uint32_t Add(unsigned int id, const TCollider& collider)
+	{
+		m_colliders.push_back(collider);
+		m_ids.push_back(id);
+		return static_cast<std::uint32_t>(m_colliders.size() - 1);
+	}
+	void Reserve(size_t size)
+	{
+		m_colliders.reserve(size);
+		m_ids.reserve(size);
+	}
+	static constexpr unsigned int s_none = static_cast<unsigned int>(-1);
+
+	// Returns the id of the collider moved to index, s_none if the removed one was last
+	unsigned int Remove(std::uint32_t index)
+	{
+		m_colliders[index] = m_colliders.back();
+		m_ids[index] = m_ids.back();
+		m_colliders.pop_back();
+		m_ids.pop_back();
+		return index < m_ids.size() ? m_ids[index] : s_none;
+	}
+
+	TCollider& operator[](std::uint32_t index)
+	{
+		return m_colliders[index];
+	}
+	const TCollider& operator[](std::uint32_t index) const
+	{
+		return m_colliders[index];
+	}
+	size_t Size() const noexcept
+	{
+		return m_colliders.size();
+	}
+};
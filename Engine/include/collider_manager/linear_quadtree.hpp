@@ -0,0 +1,298 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <span>
+#include <cstdint>
+
+#include "collider_handlers.hpp"
+#include "quadtree.hpp"
+#include "aabb_columns.hpp"
+#include "profiler/profiler.hpp"
+#include "glm/glm.hpp"
+
+// Quadtree with every node of every level in one flat array, addressed by level offset plus
+// the Morton code of the cell. An item lives in the deepest cell that contains it; items of a
+// node are a packed range of the box and id arrays. A full range is moved to the end of the
+// arrays with twice the capacity, and the arrays are compacted once moved-out ranges make up
+// a quarter of them. Same interface and bounds semantics as Quadtree: boxes not strictly inside
+// the root square are ignored.
+class LinearQuadtree
+{
+private:
+	static constexpr unsigned int s_max_depth = 7;
+	static constexpr std::uint32_t s_grid_size = 1u << s_max_depth;
+	static constexpr std::uint32_t s_invalid = static_cast<std::uint32_t>(-1);
+
+	struct Node
+	{
+		std::uint32_t begin = 0;
+		std::uint32_t count = 0;
+		std::uint32_t capacity = 0;
+		// Items in this node and all its descendants, lets queries skip empty subtrees
+		std::uint32_t subtree_count = 0;
+	};
+	// Cell range on the finest grid
+	struct GridRange
+	{
+		std::uint32_t min_x, min_y, max_x, max_y;
+	};
+	struct Location
+	{
+		unsigned int level;
+		std::uint32_t x, y;
+	};
+
+	glm::vec2 m_pos;
+	float m_width;
+	float m_inverse_cell_size;
+	std::vector<Node> m_nodes;
+	AABBColumns m_boxes;
+	std::vector<unsigned int> m_ids;
+	// Indexed by item id
+	std::vector<std::uint32_t> m_slot_of_id;
+	size_t m_garbage = 0;
+
+	static constexpr std::uint32_t LevelOffset(unsigned int level)
+	{
+		return ((1u << (2 * level)) - 1) / 3;
+	}
+	static std::uint32_t Morton(std::uint32_t x, std::uint32_t y);
+	static std::uint32_t NodeIndex(const Location& location)
+	{
+		return LevelOffset(location.level) + Morton(location.x, location.y);
+	}
+
+	bool Contains(const AABB& bb) const
+	{
+		return m_pos.x < bb.min.x && bb.max.x < m_pos.x + m_width &&
+			m_pos.y < bb.min.y && bb.max.y < m_pos.y + m_width;
+	}
+	GridRange Quantize(const AABB& bb) const;
+	Location Locate(const AABB& bb) const;
+	void AddToSubtreeCounts(const Location& location, int delta);
+	void Grow(Node& node);
+	void Compact();
+	void InsertAt(unsigned int id, const AABB& bb, const Location& location);
+	void RemoveAt(unsigned int id, const Location& location);
+
+	bool Overlaps(const Location& location, const GridRange& range) const
+	{
+		unsigned int shift = s_max_depth - location.level;
+		std::uint32_t min_x = location.x << shift, min_y = location.y << shift;
+		std::uint32_t max_x = min_x + (1u << shift) - 1, max_y = min_y + (1u << shift) - 1;
+		return !(max_x < range.min_x || min_x > range.max_x || max_y < range.min_y || min_y > range.max_y);
+	}
+	// Queries listed in queries_at[begin, end) all overlap this node's cell; lists for the
+	// children are appended to queries_at and dropped again on the way back
+	template <typename Container>
+	void IntersectBatch(const Location& location, std::vector<std::uint32_t>& queries_at, size_t begin, size_t end,
+		std::span<const AABB> queries, const std::vector<GridRange>& ranges, Container& pairs) const
+	{
+		const Node& node = m_nodes[NodeIndex(location)];
+		for (size_t i = begin; i < end; ++i)
+		{
+			std::uint32_t query = queries_at[i];
+			m_boxes.ForEachOverlapping(node.begin, node.begin + node.count, queries[query], [&](std::uint32_t slot) {
+				pairs.push_back({ query, m_ids[slot] });
+				});
+		}
+		if (location.level == s_max_depth || node.subtree_count == node.count)
+			return;
+		for (std::uint32_t child = 0; child < 4; ++child)
+		{
+			Location child_location{ location.level + 1, 2 * location.x + (child & 1), 2 * location.y + (child >> 1) };
+			if (m_nodes[NodeIndex(child_location)].subtree_count == 0)
+				continue;
+			size_t child_begin = queries_at.size();
+			for (size_t i = begin; i < end; ++i)
+				if (Overlaps(child_location, ranges[queries_at[i]]))
+					queries_at.push_back(queries_at[i]);
+			if (queries_at.size() > child_begin)
+				IntersectBatch(child_location, queries_at, child_begin, queries_at.size(), queries, ranges, pairs);
+			queries_at.resize(child_begin);
+		}
+	}
+public:
+	LinearQuadtree(glm::vec2 pos = glm::vec2(-1.f), float width = 2);
+
+	void Insert(unsigned int id, const AABB& bb);
+	void Delete(unsigned int id, const AABB& bb);
+	// Rewrites the box in place when the item stays in the same cell
+	void Update(unsigned int id, const AABB& old_bb, const AABB& new_bb);
+
+	std::vector<unsigned int> GetIntersection(const AABB& bb) const
+	{
+		std::vector<unsigned int> intersection;
+		GetIntersection(bb, intersection);
+		return intersection;
+	}
+	// Appends to the given container, e.g. a FrameVector reused across queries
+	template <typename Container>
+	void GetIntersection(const AABB& bb, Container& intersection) const
+	{
+		ENGINE_PROFILE_SCOPE("LinearQuadtree::GetIntersection");
+		if (m_nodes[0].subtree_count == 0)
+			return;
+		// Nodes are tested in grid coordinates, the same quantization placed the items, so no
+		// item is skipped because of float rounding at cell borders
+		GridRange query = Quantize(bb);
+		std::array<Location, 4 * (s_max_depth + 1)> stack;
+		size_t top = 0;
+		stack[top++] = { 0, 0, 0 };
+		while (top > 0)
+		{
+			Location location = stack[--top];
+			const Node& node = m_nodes[NodeIndex(location)];
+			m_boxes.ForEachOverlapping(node.begin, node.begin + node.count, bb, [&](std::uint32_t slot) {
+				intersection.push_back(m_ids[slot]);
+				});
+
+			if (location.level == s_max_depth || node.subtree_count == node.count)
+				continue;
+			for (std::uint32_t child = 0; child < 4; ++child)
+			{
+				Location child_location{ location.level + 1, 2 * location.x + (child & 1), 2 * location.y + (child >> 1) };
+				if (Overlaps(child_location, query) && m_nodes[NodeIndex(child_location)].subtree_count > 0)
+					stack[top++] = child_location;
+			}
+		}
+	}
+	// Calls test(id) for the items whose box, grown by margin, the segment origin + t * motion
+	// crosses for t in [0, max_time], nearest cells first. test returns the item's hit time
+	// (infinity for a miss) and a hit shortens the segment for the rest of the walk, so cells
+	// behind it are skipped. Returns the final max_time.
+	template <typename F>
+	float Raycast(glm::vec2 origin, glm::vec2 motion, float margin, float max_time, F&& test) const
+	{
+		ENGINE_PROFILE_SCOPE("LinearQuadtree::Raycast");
+		if (m_nodes[0].subtree_count == 0)
+			return max_time;
+		glm::vec2 inverse_motion = glm::vec2(1.f) / motion;
+		// Items were placed by quantization and may stick out of their cell by a rounding error
+		float cell_margin = margin + m_width / s_grid_size / 256.f;
+		auto cell_entry = [&](const Location& location) {
+			float size = m_width / static_cast<float>(1u << location.level);
+			glm::vec2 min = m_pos + size * glm::vec2(location.x, location.y);
+			return segment_entry(origin, inverse_motion, { min + glm::vec2(size), min }, cell_margin, max_time);
+			};
+		struct Pending
+		{
+			Location location;
+			float time;
+		};
+		std::array<Pending, 4 * (s_max_depth + 1)> stack;
+		size_t top = 0;
+		stack[top++] = { { 0, 0, 0 }, cell_entry({ 0, 0, 0 }) };
+		while (top > 0)
+		{
+			Pending pending = stack[--top];
+			if (pending.time > max_time)
+				continue;
+			const Node& node = m_nodes[NodeIndex(pending.location)];
+			for (std::uint32_t slot = node.begin; slot < node.begin + node.count; ++slot)
+				if (segment_entry(origin, inverse_motion, m_boxes.Get(slot), margin, max_time) <= max_time)
+					max_time = std::min(max_time, test(m_ids[slot]));
+
+			if (pending.location.level == s_max_depth || node.subtree_count == node.count)
+				continue;
+			// Children pushed farthest first so the nearest is walked next
+			size_t first = top;
+			for (std::uint32_t child = 0; child < 4; ++child)
+			{
+				Location child_location{ pending.location.level + 1, 2 * pending.location.x + (child & 1), 2 * pending.location.y + (child >> 1) };
+				if (m_nodes[NodeIndex(child_location)].subtree_count == 0)
+					continue;
+				float time = cell_entry(child_location);
+				if (time > max_time)
+					continue;
+				size_t i = top++;
+				for (; i > first && stack[i - 1].time < time; --i)
+					stack[i] = stack[i - 1];
+				stack[i] = { child_location, time };
+			}
+		}
+		return max_time;
+	}
+	// test(id) for the items whose box lies within max_distance of point, nearest cell first.
+	// test returns a bound for the rest of the walk (e.g. the k-th smallest distance so far) and
+	// cells farther than it are skipped. Returns the final bound.
+	template <typename F>
+	float Nearest(glm::vec2 point, float max_distance, F&& test) const
+	{
+		ENGINE_PROFILE_SCOPE("LinearQuadtree::Nearest");
+		if (m_nodes[0].subtree_count == 0)
+			return max_distance;
+		float cell_margin = m_width / s_grid_size / 256.f;
+		auto cell_distance = [&](const Location& location) {
+			float size = m_width / static_cast<float>(1u << location.level);
+			glm::vec2 min = m_pos + size * glm::vec2(location.x, location.y);
+			return box_distance(point, { min + glm::vec2(size + cell_margin), min - glm::vec2(cell_margin) });
+			};
+		struct Pending
+		{
+			Location location;
+			float distance;
+		};
+		std::array<Pending, 4 * (s_max_depth + 1)> stack;
+		size_t top = 0;
+		stack[top++] = { { 0, 0, 0 }, cell_distance({ 0, 0, 0 }) };
+		while (top > 0)
+		{
+			Pending pending = stack[--top];
+			if (pending.distance > max_distance)
+				continue;
+			const Node& node = m_nodes[NodeIndex(pending.location)];
+			for (std::uint32_t slot = node.begin; slot < node.begin + node.count; ++slot)
+				if (box_distance(point, m_boxes.Get(slot)) <= max_distance)
+					max_distance = std::min(max_distance, test(m_ids[slot]));
+
+			if (pending.location.level == s_max_depth || node.subtree_count == node.count)
+				continue;
+			size_t first = top;
+			for (std::uint32_t child = 0; child < 4; ++child)
+			{
+				Location child_location{ pending.location.level + 1, 2 * pending.location.x + (child & 1), 2 * pending.location.y + (child >> 1) };
+				if (m_nodes[NodeIndex(child_location)].subtree_count == 0)
+					continue;
+				float distance = cell_distance(child_location);
+				if (distance > max_distance)
+					continue;
+				size_t i = top++;
+				for (; i > first && stack[i - 1].distance < distance; --i)
+					stack[i] = stack[i - 1];
+				stack[i] = { child_location, distance };
+			}
+		}
+		return max_distance;
+	}
+	// Every item overlapping each of the query boxes, as (query index, id) pairs. The tree is
+	// walked once for the whole batch, each node with the queries that reach it.
+	template <typename Container>
+	void GetIntersections(std::span<const AABB> queries, Container& pairs) const
+	{
+		ENGINE_PROFILE_SCOPE("LinearQuadtree::GetIntersections");
+		if (m_nodes[0].subtree_count == 0 || queries.empty())
+			return;
+		std::vector<GridRange> ranges(queries.size());
+		std::vector<std::uint32_t> queries_at(queries.size());
+		for (std::uint32_t query = 0; query < queries.size(); ++query)
+		{
+			ranges[query] = Quantize(queries[query]);
+			queries_at[query] = query;
+		}
+		IntersectBatch({ 0, 0, 0 }, queries_at, 0, queries.size(), queries, ranges, pairs);
+	}
+
+	size_t Size() const noexcept
+	{
+		return m_nodes[0].subtree_count;
+	}
+	// Item count of every depth, the root first
+	std::vector<size_t> ItemsPerLevel() const;
+	// Bytes held by the node and item arrays
+	size_t MemoryUsage() const noexcept
+	{
+		return m_nodes.capacity() * sizeof(Node) + m_boxes.Capacity() * 4 * sizeof(float)
+			+ m_ids.capacity() * sizeof(unsigned int) + m_slot_of_id.capacity() * sizeof(std::uint32_t);
+	}
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <bit>
+
+#include "collider_handlers.hpp"
+#include "simd.hpp"
+
+// Circle/rect candidate pairs gathered into columns and tested several per instruction with the
+// same distance test as ColliderCircle::Test. The rect is a capsule around its axis segment.
+class CircleRectBatch
+{
+private:
+	std::vector<float> m_circle_x, m_circle_y, m_reach;
+	std::vector<float> m_start_x, m_start_y, m_axis_x, m_axis_y;
+	std::vector<unsigned int> m_circle_ids, m_rect_ids;
+	std::vector<std::uint32_t> m_tags;
+	size_t m_size = 0;
+
+	void Pad();
+	// Bit i set when pair first + i is in contact, normals written for every lane
+	unsigned int ContactMask(size_t first, float* normal_x, float* normal_y) const;
+public:
+	size_t Size() const noexcept
+	{
+		return m_size;
+	}
+	void Clear();
+	// The tag is handed back with the pair's contact, e.g. the categories of both colliders
+	void Add(const Circle& circle, unsigned int circle_id, const Rect& rect, unsigned int rect_id, std::uint32_t tag = 0);
+
+	// Appends a CircleRectCollideInfo and its tag per pair in contact, in the order the pairs were added
+	template <typename Container, typename TagContainer>
+	void Evaluate(Container& contacts, TagContainer& tags)
+	{
+		Pad();
+		alignas(32) float normal_x[simd_width], normal_y[simd_width];
+		for (size_t first = 0; first < m_size; first += simd_width)
+		{
+			unsigned int mask = ContactMask(first, normal_x, normal_y);
+			if (m_size - first < simd_width)
+				mask &= (1u << (m_size - first)) - 1;
+			while (mask)
+			{
+				unsigned int lane = static_cast<unsigned int>(std::countr_zero(mask));
+				contacts.push_back({ { normal_x[lane], normal_y[lane] }, m_circle_ids[first + lane], m_rect_ids[first + lane] });
+				tags.push_back(m_tags[first + lane]);
+				mask &= mask - 1;
+			}
+		}
+	}
+};
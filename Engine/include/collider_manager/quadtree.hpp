@@ -1,8 +1,13 @@
 #pragma once
 #include <unordered_map>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
 
 #include "collider_handlers.hpp"
+#include "profiler/profiler.hpp"
 #include "glm/glm.hpp"
 
 inline bool intersects(const AABB& bb1, const AABB& bb2)
@@ -10,6 +15,32 @@ inline bool intersects(const AABB& bb1, const AABB& bb2)
 	return (bb1.max.x > bb2.min.x && bb2.max.x > bb1.min.x && bb1.max.y > bb2.min.y && bb2.max.y > bb1.min.y);
 }
 
+// Smallest t in [0, max_time] at which origin + t * motion is inside bb grown by margin,
+// infinity if there is none; inverse_motion is 1 / motion per component
+inline float segment_entry(glm::vec2 origin, glm::vec2 inverse_motion, const AABB& bb, float margin, float max_time)
+{
+	float t_min = 0.f, t_max = max_time;
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		float t1 = (bb.min[axis] - margin - origin[axis]) * inverse_motion[axis];
+		float t2 = (bb.max[axis] + margin - origin[axis]) * inverse_motion[axis];
+		t_min = std::max(t_min, std::min(t1, t2));
+		t_max = std::min(t_max, std::max(t1, t2));
+	}
+	return t_min <= t_max ? t_min : std::numeric_limits<float>::infinity();
+}
+
+// Distance from point to bb, 0 inside it
+inline float box_distance(glm::vec2 point, const AABB& bb)
+{
+	glm::vec2 outside = glm::max(glm::max(bb.min - point, point - bb.max), glm::vec2(0.f));
+	return std::sqrt(glm::dot(outside, outside));
+}
+
+// With a looseness above 1 every node below the root accepts items within its cell scaled by
+// that factor around the cell centre, and an item goes to the child holding its centre. Items
+// crossing a centre line then sink to the depth matching their size instead of piling up in
+// the parents; with 1 the tree is a plain quadtree.
 class Quadtree
 {
 private:
@@ -20,9 +51,15 @@ private:
 		std::unordered_map<unsigned int, AABB> m_items;
 		glm::vec2 m_pos;
 		float m_width;
+		float m_looseness;
+		// Loose bounds, the cell itself for the root
+		AABB m_bounds;
 	public:
 
 		static constexpr int s_max_el_count = 20;
+		// Children merge back only at half the split size, so a node near the threshold does not
+		// split and merge again every frame
+		static constexpr int s_merge_el_count = s_max_el_count / 2;
 		static constexpr int s_max_depth = 5;
 		enum Quads {
 			None = -1,
@@ -31,8 +68,15 @@ private:
 			BottomRight = 2,
 			BottomLeft = 3
 		};
-		QuadtreeNode(glm::vec2 pos, float width) : m_pos(pos), m_width(width)
-		{};
+		QuadtreeNode(glm::vec2 pos, float width, float looseness, bool is_root = false) :
+			m_pos(pos),
+			m_width(width),
+			m_looseness(looseness)
+		{
+			glm::vec2 half(width / 2.f * (is_root ? 1.f : looseness));
+			glm::vec2 centre = pos + glm::vec2(width / 2.f);
+			m_bounds = { centre + half, centre - half };
+		};
 
 		bool IsTerminate() const
 		{
@@ -41,14 +85,13 @@ private:
 
 		bool Intersects(const AABB& bb) const
 		{
-			return (bb.max.x > m_pos.x && m_pos.x + m_width > bb.min.x 
-				&& bb.max.y > m_pos.y && m_pos.y + m_width > bb.min.y);
+			return intersects(m_bounds, bb);
 		}
 
 		bool Contains(const AABB& bb) const
 		{
-			return m_pos.x < bb.min.x &&  bb.max.x < m_pos.x + m_width &&
-				m_pos.y < bb.min.y && bb.max.y < m_pos.y + m_width;
+			return m_bounds.min.x < bb.min.x && bb.max.x < m_bounds.max.x &&
+				m_bounds.min.y < bb.min.y && bb.max.y < m_bounds.max.y;
 		}
 		Quads GetQuad(const AABB& bb) const;
 		void Subdivide();
@@ -56,32 +99,69 @@ private:
 		void Insert(unsigned int id, const AABB& bb, int depth = 0);
 
 		void Remove(unsigned int id, const AABB& bb, QuadtreeNode* parent = nullptr);
-		void IntersectQuery(const AABB& bb, std::vector<unsigned int>& intersection_ids) const;
-	} *root;
+		// Rewrites the item's box when new_bb belongs to the node holding it, false otherwise
+		bool Move(unsigned int id, const AABB& old_bb, const AABB& new_bb);
+		void CountItems(std::vector<size_t>& items_per_level, size_t depth) const;
+		template <typename Container>
+		void IntersectQuery(const AABB& bb, Container& intersection_ids) const
+		{
+			for (const auto& val_p : m_items)
+			{
+				if (intersects(val_p.second, bb))
+					intersection_ids.push_back(val_p.first);
+			}
+			if (!IsTerminate())
+			{
+				for (int i = 0; i < 4; ++i)
+					if (quads[i]->Intersects(bb))
+						quads[i]->IntersectQuery(bb, intersection_ids);
+			}
+		}
+	};
+	std::unique_ptr<QuadtreeNode> root;
 public:
-	Quadtree(glm::vec2 pos = glm::vec2(-1.f), float width = 2) 
-		: root(new QuadtreeNode(pos, width))
+	Quadtree(glm::vec2 pos = glm::vec2(-1.f), float width = 2, float looseness = 1.f)
+		: root(std::make_unique<QuadtreeNode>(pos, width, looseness, true))
 	{}
 	
 	void Insert(unsigned id, const AABB& bb)
 	{
+		ENGINE_PROFILE_SCOPE("Quadtree::Insert");
 		if(root->Contains(bb))
 			root->Insert(id, bb);
 	}
 	void Delete(unsigned id, const AABB& bb)
 	{
+		ENGINE_PROFILE_SCOPE("Quadtree::Delete");
 		if (root->Contains(bb))
 			root->Remove(id, bb);
 	}
+	// In place when the item stays in its node, without the merge and split a Delete and Insert may do
 	void Update(unsigned id, const AABB& old_bb, const AABB& new_bb)
 	{
+		if (root->Contains(old_bb) && root->Contains(new_bb) && root->Move(id, old_bb, new_bb))
+			return;
 		Delete(id, old_bb);
 		Insert(id, new_bb);
 	}
 	std::vector<unsigned int> GetIntersection(const AABB& bb) const
 	{
 		std::vector<unsigned int> intersection;
-		root->IntersectQuery(bb, intersection);
+		GetIntersection(bb, intersection);
 		return intersection;
 	}
+	// Appends to the given container, e.g. a FrameVector reused across queries
+	template <typename Container>
+	void GetIntersection(const AABB& bb, Container& intersection) const
+	{
+		ENGINE_PROFILE_SCOPE("Quadtree::GetIntersection");
+		root->IntersectQuery(bb, intersection);
+	}
+	// Item count of every depth, the root first
+	std::vector<size_t> ItemsPerLevel() const
+	{
+		std::vector<size_t> items_per_level;
+		root->CountItems(items_per_level, 0);
+		return items_per_level;
+	}
 };
\ No newline at end of file
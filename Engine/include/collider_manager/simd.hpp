@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+
+// Widest float vector the compiler targets: ENGINE_SIMD_AVX2 (8 lanes), ENGINE_SIMD_SSE2 (4) or
+// neither, in which case kernels fall back to one lane
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ENGINE_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ENGINE_SIMD_SSE2
+#endif
+
+#if defined(ENGINE_SIMD_AVX2)
+inline constexpr std::uint32_t simd_width = 8;
+#elif defined(ENGINE_SIMD_SSE2)
+inline constexpr std::uint32_t simd_width = 4;
+#else
+inline constexpr std::uint32_t simd_width = 1;
+#endif
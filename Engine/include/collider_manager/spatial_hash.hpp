@@ -0,0 +1,98 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include "collider_handlers.hpp"
+#include "quadtree.hpp"
+#include "profiler/profiler.hpp"
+#include "glm/glm.hpp"
+
+// Uniform grid of square cells hashed into a power-of-two bucket table. An item is listed in
+// every cell its box overlaps; boxes are kept per id, so a move that covers the same cells
+// only rewrites the box. Same interface and bounds semantics as Quadtree: boxes not strictly
+// inside the square at pos with the given width are ignored.
+class SpatialHash
+{
+private:
+	static constexpr std::uint32_t s_max_bucket_count = 1u << 16;
+
+	struct CellRange
+	{
+		std::int32_t min_x, min_y, max_x, max_y;
+
+		bool operator==(const CellRange&) const = default;
+	};
+
+	glm::vec2 m_pos;
+	float m_width;
+	float m_inverse_cell_size;
+	std::int32_t m_cells_per_side;
+	std::uint32_t m_bucket_mask;
+	std::vector<std::vector<unsigned int>> m_buckets;
+	// Indexed by item id
+	std::vector<AABB> m_boxes;
+	std::vector<bool> m_present;
+	size_t m_size = 0;
+	// Buckets of the item being inserted or removed, an item is listed once per bucket
+	std::vector<std::uint32_t> m_item_buckets;
+
+	bool Contains(const AABB& bb) const
+	{
+		return m_pos.x < bb.min.x && bb.max.x < m_pos.x + m_width &&
+			m_pos.y < bb.min.y && bb.max.y < m_pos.y + m_width;
+	}
+	bool IsPresent(unsigned int id) const
+	{
+		return id < m_present.size() && m_present[id];
+	}
+	// Clamped to the grid, exact for boxes inside the bounds
+	CellRange Cells(const AABB& bb) const;
+	std::uint32_t Hash(std::int32_t x, std::int32_t y) const
+	{
+		return ((static_cast<std::uint32_t>(x) * 73856093u) ^ (static_cast<std::uint32_t>(y) * 19349663u)) & m_bucket_mask;
+	}
+	void CollectBuckets(const CellRange& cells);
+	void InsertCells(unsigned int id, const CellRange& cells);
+	void RemoveCells(unsigned int id, const CellRange& cells);
+public:
+	// A cell_size of 0 picks width / 64
+	SpatialHash(glm::vec2 pos = glm::vec2(-1.f), float width = 2, float cell_size = 0.f);
+
+	void Insert(unsigned int id, const AABB& bb);
+	void Delete(unsigned int id, const AABB& bb);
+	// O(1) when the box still covers the same cells
+	void Update(unsigned int id, const AABB& old_bb, const AABB& new_bb);
+
+	std::vector<unsigned int> GetIntersection(const AABB& bb) const
+	{
+		std::vector<unsigned int> intersection;
+		GetIntersection(bb, intersection);
+		return intersection;
+	}
+	// Appends to the given container, e.g. a FrameVector reused across queries
+	template <typename Container>
+	void GetIntersection(const AABB& bb, Container& intersection) const
+	{
+		ENGINE_PROFILE_SCOPE("SpatialHash::GetIntersection");
+		CellRange query = Cells(bb);
+		for (std::int32_t y = query.min_y; y <= query.max_y; ++y)
+			for (std::int32_t x = query.min_x; x <= query.max_x; ++x)
+				for (unsigned int id : m_buckets[Hash(x, y)])
+				{
+					const AABB& item = m_boxes[id];
+					if (!intersects(item, bb))
+						continue;
+					// An item spanning several cells is reported from the first cell it shares
+					// with the query only, which also skips items of other cells hashed here
+					CellRange cells = Cells(item);
+					if (x == std::max(cells.min_x, query.min_x) && y == std::max(cells.min_y, query.min_y))
+						intersection.push_back(id);
+				}
+	}
+
+	size_t Size() const noexcept
+	{
+		return m_size;
+	}
+};
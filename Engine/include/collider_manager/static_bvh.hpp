@@ -0,0 +1,248 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <span>
+#include <cstdint>
+
+#include "collider_handlers.hpp"
+#include "quadtree.hpp"
+#include "aabb_columns.hpp"
+#include "profiler/profiler.hpp"
+#include "scheduler/job_system.hpp"
+#include "glm/glm.hpp"
+
+// Bounding volume hierarchy over boxes that do not move, built once with binned SAH splits.
+// Nodes are packed depth first in one array: an inner node's left child follows it and it
+// stores the index of its right child; a leaf stores a range of the item array. Remove only
+// marks the item, the tree is not restructured until the next Build.
+class StaticBVH
+{
+private:
+	static constexpr std::uint32_t s_removed = static_cast<std::uint32_t>(-1);
+	static constexpr std::uint32_t s_max_leaf_size = 4;
+	static constexpr unsigned int s_bin_count = 16;
+	// Below this depth splits fall back to the median, which bounds the traversal stack
+	static constexpr unsigned int s_max_sah_depth = 64;
+	static constexpr size_t s_max_stack = 128;
+
+	struct Node
+	{
+		AABB bb;
+		// Leaf: first item; inner node: right child
+		std::uint32_t index;
+		// Items in a leaf, 0 for an inner node
+		std::uint32_t count;
+	};
+	struct Item
+	{
+		AABB bb;
+		unsigned int id;
+	};
+
+	std::vector<Node> m_nodes;
+	// Items in leaf order, s_removed in m_ids for removed ones
+	AABBColumns m_boxes;
+	std::vector<unsigned int> m_ids;
+	// Indexed by id
+	std::vector<std::uint32_t> m_item_of_id;
+	size_t m_removed = 0;
+
+	// Range whose subtree a parallel build leaves to a job; the top of the tree holds a node with
+	// count s_deferred and the subtree's number as index in its place until it is spliced in
+	struct Subtree
+	{
+		std::uint32_t begin;
+		std::uint32_t end;
+		unsigned int depth;
+		std::vector<Node> nodes;
+	};
+	static constexpr std::uint32_t s_deferred = static_cast<std::uint32_t>(-1);
+	static constexpr std::uint32_t s_min_subtree_size = 2048;
+
+	// Appends the subtree of items [begin, end) to nodes; ranges up to subtree_size are deferred
+	// to subtrees when it is given
+	std::uint32_t BuildNode(std::vector<Node>& nodes, std::vector<Item>& items, std::uint32_t begin, std::uint32_t end, unsigned int depth,
+		std::vector<Subtree>* subtrees = nullptr, std::uint32_t subtree_size = 0);
+	// Copies the node of top at index into m_nodes, the deferred ones replaced by their subtree
+	std::uint32_t Splice(const std::vector<Node>& top, std::uint32_t index, const std::vector<Subtree>& subtrees);
+
+	template <typename F>
+	void ForEachInLeaf(const Node& leaf, const AABB& bb, F&& f) const
+	{
+		m_boxes.ForEachOverlapping(leaf.index, leaf.index + leaf.count, bb, [&](std::uint32_t item) {
+			if (m_ids[item] != s_removed)
+				f(m_ids[item]);
+			});
+	}
+	// Queries listed in queries_at[begin, end) all overlap the node's box
+	template <typename Container>
+	void IntersectBatch(std::uint32_t index, std::vector<std::uint32_t>& queries_at, size_t begin, size_t end,
+		std::span<const AABB> queries, Container& pairs) const
+	{
+		const Node& node = m_nodes[index];
+		if (node.count > 0)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				std::uint32_t query = queries_at[i];
+				ForEachInLeaf(node, queries[query], [&](unsigned int id) { pairs.push_back({ query, id }); });
+			}
+			return;
+		}
+		for (std::uint32_t child : { index + 1, node.index })
+		{
+			size_t child_begin = queries_at.size();
+			for (size_t i = begin; i < end; ++i)
+				if (intersects(m_nodes[child].bb, queries[queries_at[i]]))
+					queries_at.push_back(queries_at[i]);
+			if (queries_at.size() > child_begin)
+				IntersectBatch(child, queries_at, child_begin, queries_at.size(), queries, pairs);
+			queries_at.resize(child_begin);
+		}
+	}
+public:
+	struct Entry
+	{
+		unsigned int id;
+		AABB bb;
+	};
+
+	// Replaces the whole tree; with a job system large trees are built as parallel subtrees,
+	// giving the same tree as a serial build
+	void Build(const std::vector<Entry>& entries, JobSystem* jobs = nullptr);
+	void Remove(unsigned int id);
+
+	// Ids of items removed since the last Build
+	size_t RemovedCount() const noexcept
+	{
+		return m_removed;
+	}
+	size_t Size() const noexcept
+	{
+		return m_ids.size() - m_removed;
+	}
+
+	// Appends to the given container, e.g. a FrameVector reused across queries
+	template <typename Container>
+	void GetIntersection(const AABB& bb, Container& intersection) const
+	{
+		ENGINE_PROFILE_SCOPE("StaticBVH::GetIntersection");
+		if (m_nodes.empty())
+			return;
+		std::array<std::uint32_t, s_max_stack> stack;
+		size_t top = 0;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			std::uint32_t index = stack[--top];
+			while (true)
+			{
+				const Node& node = m_nodes[index];
+				if (!intersects(node.bb, bb))
+					break;
+				if (node.count > 0)
+				{
+					ForEachInLeaf(node, bb, [&](unsigned int id) { intersection.push_back(id); });
+					break;
+				}
+				stack[top++] = node.index;
+				++index;
+			}
+		}
+	}
+	// Same contract as LinearQuadtree::Raycast: test(id) for items whose grown box the segment
+	// crosses, nearer child first, hits shortening the segment. Returns the final max_time.
+	template <typename F>
+	float Raycast(glm::vec2 origin, glm::vec2 motion, float margin, float max_time, F&& test) const
+	{
+		ENGINE_PROFILE_SCOPE("StaticBVH::Raycast");
+		if (m_nodes.empty())
+			return max_time;
+		glm::vec2 inverse_motion = glm::vec2(1.f) / motion;
+		struct Pending
+		{
+			std::uint32_t index;
+			float time;
+		};
+		std::array<Pending, s_max_stack> stack;
+		size_t top = 0;
+		stack[top++] = { 0, segment_entry(origin, inverse_motion, m_nodes[0].bb, margin, max_time) };
+		while (top > 0)
+		{
+			Pending pending = stack[--top];
+			if (pending.time > max_time)
+				continue;
+			const Node& node = m_nodes[pending.index];
+			if (node.count > 0)
+			{
+				for (std::uint32_t item = node.index; item < node.index + node.count; ++item)
+					if (m_ids[item] != s_removed && segment_entry(origin, inverse_motion, m_boxes.Get(item), margin, max_time) <= max_time)
+						max_time = std::min(max_time, test(m_ids[item]));
+				continue;
+			}
+			Pending left{ pending.index + 1, segment_entry(origin, inverse_motion, m_nodes[pending.index + 1].bb, margin, max_time) };
+			Pending right{ node.index, segment_entry(origin, inverse_motion, m_nodes[node.index].bb, margin, max_time) };
+			if (left.time < right.time)
+				std::swap(left, right);
+			// The farther child below the nearer one on the stack
+			for (const Pending& child : { left, right })
+				if (child.time <= max_time)
+					stack[top++] = child;
+		}
+		return max_time;
+	}
+	// Same contract as LinearQuadtree::Nearest
+	template <typename F>
+	float Nearest(glm::vec2 point, float max_distance, F&& test) const
+	{
+		ENGINE_PROFILE_SCOPE("StaticBVH::Nearest");
+		if (m_nodes.empty())
+			return max_distance;
+		struct Pending
+		{
+			std::uint32_t index;
+			float distance;
+		};
+		std::array<Pending, s_max_stack> stack;
+		size_t top = 0;
+		stack[top++] = { 0, box_distance(point, m_nodes[0].bb) };
+		while (top > 0)
+		{
+			Pending pending = stack[--top];
+			if (pending.distance > max_distance)
+				continue;
+			const Node& node = m_nodes[pending.index];
+			if (node.count > 0)
+			{
+				for (std::uint32_t item = node.index; item < node.index + node.count; ++item)
+					if (m_ids[item] != s_removed && box_distance(point, m_boxes.Get(item)) <= max_distance)
+						max_distance = std::min(max_distance, test(m_ids[item]));
+				continue;
+			}
+			Pending left{ pending.index + 1, box_distance(point, m_nodes[pending.index + 1].bb) };
+			Pending right{ node.index, box_distance(point, m_nodes[node.index].bb) };
+			if (left.distance < right.distance)
+				std::swap(left, right);
+			for (const Pending& child : { left, right })
+				if (child.distance <= max_distance)
+					stack[top++] = child;
+		}
+		return max_distance;
+	}
+	// Every item overlapping each of the query boxes, as (query index, id) pairs, from one
+	// walk of the tree for the whole batch
+	template <typename Container>
+	void GetIntersections(std::span<const AABB> queries, Container& pairs) const
+	{
+		ENGINE_PROFILE_SCOPE("StaticBVH::GetIntersections");
+		if (m_nodes.empty())
+			return;
+		std::vector<std::uint32_t> queries_at;
+		queries_at.reserve(2 * queries.size());
+		for (std::uint32_t query = 0; query < queries.size(); ++query)
+			if (intersects(m_nodes[0].bb, queries[query]))
+				queries_at.push_back(query);
+		if (!queries_at.empty())
+			IntersectBatch(0, queries_at, 0, queries_at.size(), queries, pairs);
+	}
+};
@@ -0,0 +1,138 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+#include "collider_handlers.hpp"
+#include "quadtree.hpp"
+#include "profiler/profiler.hpp"
+#include "glm/glm.hpp"
+
+// Incremental sweep and prune: box endpoints are kept sorted on both axes and a moved box is
+// put back in place by insertion sort. Every swap of a min with a max endpoint starts or ends
+// an overlap on that axis, so the set of overlapping pairs is kept up to date at a cost that
+// grows with how far boxes move rather than with their number.
+//
+// Moves and deletes apply at once. Inserted boxes are merged into the lists, and endpoints of
+// deleted boxes dropped, by Flush. Overlaps are decided by endpoint order, so boxes that only
+// touch count as overlapping. Same bounds semantics as Quadtree.
+class SweepAndPrune
+{
+private:
+	static constexpr std::uint32_t s_invalid = static_cast<std::uint32_t>(-1);
+
+	struct Endpoint
+	{
+		float value;
+		// Box slot << 1 | is max
+		std::uint32_t data;
+
+		std::uint32_t Slot() const
+		{
+			return data >> 1;
+		}
+		bool IsMax() const
+		{
+			return data & 1;
+		}
+	};
+	struct Box
+	{
+		AABB bb;
+		unsigned int id;
+		// Positions of the min and max endpoints on each axis
+		std::uint32_t endpoints[2][2];
+		bool alive;
+		bool sorted;
+	};
+
+	glm::vec2 m_pos;
+	float m_width;
+	std::array<std::vector<Endpoint>, 2> m_axes;
+	// Slots of deleted boxes are reused after their endpoints are dropped in Flush
+	std::vector<Box> m_boxes;
+	std::vector<std::uint32_t> m_free_slots;
+	std::vector<std::uint32_t> m_slot_of_id;
+	// Indexed by id
+	std::vector<std::vector<unsigned int>> m_overlaps;
+	// Slots inserted since the last Flush
+	std::vector<std::uint32_t> m_pending;
+	size_t m_dead = 0;
+	size_t m_size = 0;
+	// Widest box on the x axis since the last Flush, bounds the GetIntersection scan
+	float m_max_extent = 0.f;
+
+	bool Contains(const AABB& bb) const
+	{
+		return m_pos.x < bb.min.x && bb.max.x < m_pos.x + m_width &&
+			m_pos.y < bb.min.y && bb.max.y < m_pos.y + m_width;
+	}
+	std::uint32_t SlotOf(unsigned int id) const
+	{
+		return id < m_slot_of_id.size() ? m_slot_of_id[id] : s_invalid;
+	}
+	static float Bound(const AABB& bb, int axis, bool is_max)
+	{
+		return is_max ? bb.max[axis] : bb.min[axis];
+	}
+	bool Overlap(const Box& a, const Box& b) const
+	{
+		return a.endpoints[0][0] < b.endpoints[0][1] && b.endpoints[0][0] < a.endpoints[0][1] &&
+			a.endpoints[1][0] < b.endpoints[1][1] && b.endpoints[1][0] < a.endpoints[1][1];
+	}
+	void AddPair(unsigned int a, unsigned int b);
+	void RemovePair(unsigned int a, unsigned int b);
+	void RemovePairs(unsigned int id);
+	void Swap(int axis, std::uint32_t position);
+	void Sift(int axis, std::uint32_t position);
+	void MoveEndpoints(std::uint32_t slot, int axis);
+	void Reindex(int axis);
+	void FindNewPairs();
+public:
+	SweepAndPrune(glm::vec2 pos = glm::vec2(-1.f), float width = 2);
+
+	void Insert(unsigned int id, const AABB& bb);
+	void Delete(unsigned int id, const AABB& bb);
+	void Update(unsigned int id, const AABB& old_bb, const AABB& new_bb);
+	// Sorts in the boxes inserted since the last call and reports their overlaps
+	void Flush();
+
+	// Ids whose boxes overlap the box of id, as of the last Flush for newly inserted boxes
+	template <typename F>
+	void ForEachOverlap(unsigned int id, F&& f) const
+	{
+		if (id < m_overlaps.size())
+			for (auto other : m_overlaps[id])
+				f(other);
+	}
+
+	std::vector<unsigned int> GetIntersection(const AABB& bb) const
+	{
+		std::vector<unsigned int> intersection;
+		GetIntersection(bb, intersection);
+		return intersection;
+	}
+	// Appends to the given container, e.g. a FrameVector reused across queries
+	template <typename Container>
+	void GetIntersection(const AABB& bb, Container& intersection) const
+	{
+		ENGINE_PROFILE_SCOPE("SweepAndPrune::GetIntersection");
+		const auto& axis = m_axes[0];
+		auto it = std::partition_point(axis.begin(), axis.end(), [&](const Endpoint& e) { return e.value < bb.min.x - m_max_extent; });
+		for (; it != axis.end() && it->value < bb.max.x; ++it)
+		{
+			const Box& box = m_boxes[it->Slot()];
+			if (!it->IsMax() && box.alive && intersects(box.bb, bb))
+				intersection.push_back(box.id);
+		}
+		for (auto slot : m_pending)
+			if (m_boxes[slot].alive && intersects(m_boxes[slot].bb, bb))
+				intersection.push_back(m_boxes[slot].id);
+	}
+
+	size_t Size() const noexcept
+	{
+		return m_size;
+	}
+};
@@ -0,0 +1,16 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// Components shared between managers; manager-specific ones live next to their manager
+
+// World transform, also the per-instance render transform of instanced entities
+struct Transform2D
+{
+	glm::mat3 matrix;
+};
+
+// Id of the entity's collider in ColliderBBManager
+struct ColliderHandle
+{
+	unsigned int id;
+};
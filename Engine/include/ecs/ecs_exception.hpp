@@ -0,0 +1,20 @@
+#pragma once
+
+#include <exception>
+
+class ECSDeadEntityException : public std::exception
+{
+
+};
+class ECSMissingComponentException : public std::exception
+{
+
+};
+class ECSEmptyEntityException : public std::exception
+{
+
+};
+class ECSEntityLimitException : public std::exception
+{
+
+};
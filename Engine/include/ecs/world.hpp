@@ -0,0 +1,356 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <map>
+#include <array>
+#include <atomic>
+#include <tuple>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "ecs/ecs_exception.hpp"
+
+// 24-bit slot index and 8-bit generation packed into one id, so an entity fits wherever
+// the engine passes plain unsigned ids around (e.g. collider user ids)
+struct Entity
+{
+	static constexpr unsigned int s_index_bits = 24;
+	static constexpr std::uint32_t s_index_mask = (1u << s_index_bits) - 1;
+	static constexpr std::uint32_t s_generation_mask = (1u << (32 - s_index_bits)) - 1;
+
+	std::uint32_t value = 0;
+
+	std::uint32_t Index() const noexcept
+	{
+		return value & s_index_mask;
+	}
+	std::uint32_t Generation() const noexcept
+	{
+		return value >> s_index_bits;
+	}
+	bool operator==(const Entity&) const = default;
+};
+
+using ComponentId = unsigned int;
+
+class ComponentRegistry
+{
+private:
+	static ComponentId Next()
+	{
+		// Types are first used from whichever thread touches them first
+		static std::atomic<ComponentId> s_counter = 0;
+		return s_counter.fetch_add(1);
+	}
+public:
+	template <typename T>
+	static ComponentId Id()
+	{
+		static const ComponentId s_id = Next();
+		return s_id;
+	}
+};
+
+struct IComponentColumn
+{
+	virtual size_t Size() const = 0;
+	// Moves the last row into row and drops the last row
+	virtual void SwapRemove(size_t row) = 0;
+	// Appends row of this column to other (same component type) and swap-removes it here
+	virtual void MoveRowTo(size_t row, IComponentColumn& other) = 0;
+	virtual std::unique_ptr<IComponentColumn> CreateEmpty() const = 0;
+	virtual ~IComponentColumn() = default;
+};
+
+template <typename T>
+class ComponentColumn final : public IComponentColumn
+{
+public:
+	std::vector<T> data;
+
+	size_t Size() const override
+	{
+		return data.size();
+	}
+	void SwapRemove(size_t row) override
+	{
+		if (row + 1 != data.size())
+			data[row] = std::move(data.back());
+		data.pop_back();
+	}
+	void MoveRowTo(size_t row, IComponentColumn& other) override
+	{
+		static_cast<ComponentColumn<T>&>(other).data.push_back(std::move(data[row]));
+		SwapRemove(row);
+	}
+	std::unique_ptr<IComponentColumn> CreateEmpty() const override
+	{
+		return std::make_unique<ComponentColumn<T>>();
+	}
+};
+
+// All entities with exactly the same component set. Each component type is a dense column,
+// rows line up across columns and with the entity list.
+class Archetype
+{
+private:
+	std::vector<ComponentId> m_signature;
+	std::vector<std::unique_ptr<IComponentColumn>> m_columns;
+	std::vector<Entity> m_entities;
+public:
+	Archetype(std::vector<ComponentId> signature, std::vector<std::unique_ptr<IComponentColumn>> columns) :
+		m_signature(std::move(signature)), m_columns(std::move(columns))
+	{}
+
+	const std::vector<ComponentId>& Signature() const noexcept
+	{
+		return m_signature;
+	}
+	// -1 when the component is not part of this archetype
+	int ColumnIndex(ComponentId id) const noexcept
+	{
+		auto it = std::lower_bound(m_signature.begin(), m_signature.end(), id);
+		return it != m_signature.end() && *it == id ? static_cast<int>(it - m_signature.begin()) : -1;
+	}
+	bool Has(ComponentId id) const noexcept
+	{
+		return ColumnIndex(id) >= 0;
+	}
+	template <typename T>
+	std::vector<T>& Column()
+	{
+		return static_cast<ComponentColumn<T>&>(*m_columns[ColumnIndex(ComponentRegistry::Id<T>())]).data;
+	}
+	IComponentColumn& Column(size_t index)
+	{
+		return *m_columns[index];
+	}
+	std::vector<Entity>& Entities() noexcept
+	{
+		return m_entities;
+	}
+	size_t Size() const noexcept
+	{
+		return m_entities.size();
+	}
+	std::vector<std::unique_ptr<IComponentColumn>> CreateEmptyColumns() const
+	{
+		std::vector<std::unique_ptr<IComponentColumn>> columns;
+		columns.reserve(m_columns.size());
+		for (const auto& column : m_columns)
+			columns.push_back(column->CreateEmpty());
+		return columns;
+	}
+};
+
+// Entity/component store with archetype-grouped structure-of-arrays storage.
+// Iteration (ForEach, ForEachChunk) walks the dense columns of every matching archetype, so it
+// is a linear scan per component. Structural changes (Create, Destroy, Add, Remove) are not
+// allowed while iterating and the world is not synchronized: managers touching it declare
+// Writes<World> so the scheduler serializes them.
+class World
+{
+private:
+	struct Record
+	{
+		std::uint32_t archetype = 0;
+		std::uint32_t row = 0;
+		std::uint32_t generation = 0;
+		bool alive = false;
+	};
+	std::vector<Record> m_records;
+	std::vector<std::uint32_t> m_free_indices;
+	std::vector<std::unique_ptr<Archetype>> m_archetypes;
+	std::map<std::vector<ComponentId>, std::uint32_t> m_archetype_lookup;
+	size_t m_alive = 0;
+
+	template <typename... Components>
+	static std::vector<ComponentId> Signature()
+	{
+		std::vector<ComponentId> signature = { ComponentRegistry::Id<Components>()... };
+		std::sort(signature.begin(), signature.end());
+		return signature;
+	}
+
+	std::uint32_t FindArchetype(const std::vector<ComponentId>& signature) const
+	{
+		auto it = m_archetype_lookup.find(signature);
+		return it == m_archetype_lookup.end() ? static_cast<std::uint32_t>(-1) : it->second;
+	}
+	std::uint32_t AddArchetype(std::vector<ComponentId> signature, std::vector<std::unique_ptr<IComponentColumn>> columns);
+
+	template <typename... Components>
+	std::uint32_t GetOrCreateArchetype()
+	{
+		auto signature = Signature<Components...>();
+		std::uint32_t index = FindArchetype(signature);
+		if (index != static_cast<std::uint32_t>(-1))
+			return index;
+
+		std::vector<std::unique_ptr<IComponentColumn>> columns(sizeof...(Components));
+		((columns[std::find(signature.begin(), signature.end(), ComponentRegistry::Id<Components>()) - signature.begin()] =
+			std::make_unique<ComponentColumn<Components>>()), ...);
+		return AddArchetype(std::move(signature), std::move(columns));
+	}
+
+	Entity AllocateEntity();
+	const Record& GetRecord(Entity entity) const;
+	void RemoveRow(std::uint32_t archetype, std::uint32_t row);
+	// Moves entity to target: shared columns are moved, columns target lacks are dropped.
+	// Returns the new row; columns only target has must be pushed by the caller.
+	std::uint32_t MoveEntity(Entity entity, std::uint32_t target);
+
+	template <typename... Components, typename F, size_t... I>
+	void ForEachChunkImpl(F&& f, std::index_sequence<I...>)
+	{
+		std::array<ComponentId, sizeof...(Components)> ids = { ComponentRegistry::Id<Components>()... };
+		for (auto& archetype : m_archetypes)
+		{
+			if (archetype->Size() == 0 || !(archetype->Has(ids[I]) && ...))
+				continue;
+			f(archetype->Size(), archetype->Entities().data(), archetype->Column<Components>().data()...);
+		}
+	}
+public:
+	World() = default;
+	World(const World&) = delete;
+	World& operator=(const World&) = delete;
+
+	template <typename... Components>
+	Entity Create(Components... components)
+	{
+		static_assert(sizeof...(Components) > 0, "an entity needs at least one component");
+		std::uint32_t archetype_index = GetOrCreateArchetype<Components...>();
+		Archetype& archetype = *m_archetypes[archetype_index];
+
+		Entity entity = AllocateEntity();
+		(archetype.Column<Components>().push_back(std::move(components)), ...);
+		archetype.Entities().push_back(entity);
+
+		Record& record = m_records[entity.Index()];
+		record.archetype = archetype_index;
+		record.row = static_cast<std::uint32_t>(archetype.Size() - 1);
+		return entity;
+	}
+
+	void Destroy(Entity entity);
+
+	bool IsAlive(Entity entity) const noexcept
+	{
+		return entity.Index() < m_records.size() && m_records[entity.Index()].alive
+			&& m_records[entity.Index()].generation == entity.Generation();
+	}
+
+	template <typename T>
+	bool Has(Entity entity) const
+	{
+		return m_archetypes[GetRecord(entity).archetype]->Has(ComponentRegistry::Id<T>());
+	}
+
+	// nullptr when the entity is dead or lacks the component
+	template <typename T>
+	T* TryGet(Entity entity)
+	{
+		if (!IsAlive(entity))
+			return nullptr;
+		const Record& record = m_records[entity.Index()];
+		Archetype& archetype = *m_archetypes[record.archetype];
+		if (!archetype.Has(ComponentRegistry::Id<T>()))
+			return nullptr;
+		return &archetype.Column<T>()[record.row];
+	}
+
+	template <typename T>
+	T& Get(Entity entity)
+	{
+		T* component = TryGet<T>(entity);
+		if (!component)
+			throw ECSMissingComponentException();
+		return *component;
+	}
+
+	// Moves the entity to the archetype with T added (or overwrites an existing T)
+	template <typename T>
+	T& Add(Entity entity, T component)
+	{
+		if (T* existing = TryGet<T>(entity))
+			return *existing = std::move(component);
+
+		const Record& record = GetRecord(entity);
+		Archetype& source = *m_archetypes[record.archetype];
+		auto signature = source.Signature();
+		signature.insert(std::upper_bound(signature.begin(), signature.end(), ComponentRegistry::Id<T>()), ComponentRegistry::Id<T>());
+
+		std::uint32_t target = FindArchetype(signature);
+		if (target == static_cast<std::uint32_t>(-1))
+		{
+			auto columns = source.CreateEmptyColumns();
+			columns.insert(columns.begin() + (std::find(signature.begin(), signature.end(), ComponentRegistry::Id<T>()) - signature.begin()),
+				std::make_unique<ComponentColumn<T>>());
+			target = AddArchetype(std::move(signature), std::move(columns));
+		}
+		std::uint32_t row = MoveEntity(entity, target);
+		auto& column = m_archetypes[target]->Column<T>();
+		column.push_back(std::move(component));
+		return column[row];
+	}
+
+	template <typename T>
+	void Remove(Entity entity)
+	{
+		const Record& record = GetRecord(entity);
+		Archetype& source = *m_archetypes[record.archetype];
+		int removed = source.ColumnIndex(ComponentRegistry::Id<T>());
+		if (removed < 0)
+			return;
+		if (source.Signature().size() == 1)
+			throw ECSEmptyEntityException();
+
+		auto signature = source.Signature();
+		signature.erase(signature.begin() + removed);
+		std::uint32_t target = FindArchetype(signature);
+		if (target == static_cast<std::uint32_t>(-1))
+		{
+			auto columns = source.CreateEmptyColumns();
+			columns.erase(columns.begin() + removed);
+			target = AddArchetype(std::move(signature), std::move(columns));
+		}
+		MoveEntity(entity, target);
+	}
+
+	// f(Entity, Components&...) for every entity that has all of Components
+	template <typename... Components, typename F>
+	void ForEach(F&& f)
+	{
+		ForEachChunk<Components...>([&f](size_t count, const Entity* entities, Components*... columns) {
+			for (size_t i = 0; i < count; ++i)
+				f(entities[i], columns[i]...);
+			});
+	}
+
+	// f(count, const Entity*, Components*...) once per matching archetype with its dense columns
+	template <typename... Components, typename F>
+	void ForEachChunk(F&& f)
+	{
+		ForEachChunkImpl<Components...>(std::forward<F>(f), std::index_sequence_for<Components...>{});
+	}
+
+	template <typename... Components>
+	size_t Count()
+	{
+		size_t count = 0;
+		ForEachChunk<Components...>([&count](size_t n, const Entity*, Components*...) { count += n; });
+		return count;
+	}
+
+	size_t Size() const noexcept
+	{
+		return m_alive;
+	}
+	size_t ArchetypeCount() const noexcept
+	{
+		return m_archetypes.size();
+	}
+};
@@ -1,46 +1,173 @@
 #pragma once
 
 #include <tuple>
+#include <array>
 #include <vector>
 #include <chrono>
 #include <algorithm>
+#include <atomic>
+#include <future>
+#include <typeinfo>
+#include <thread>
 
 #include "graphic_manager/fps_counter_renderer.hpp"
+#include "manager.hpp"
+#include "scheduler/manager_scheduler.hpp"
+#include "scheduler/job_system.hpp"
+#include "scheduler/static_manager_set.hpp"
+#include "profiler/profiler.hpp"
+#include "engine_context.hpp"
+#include "memory/frame_arena.hpp"
 
-struct IManager
+// Engine-owned resources that managers can declare access to next to extensions
+constexpr unsigned long long s_world_access_bit = 1ull << 63;
+
+template <typename T, typename... Extensions>
+constexpr unsigned long long ExtensionBit()
+{
+	if constexpr (std::is_same_v<T, World>)
+		return s_world_access_bit;
+	unsigned long long bit = 0;
+	unsigned long long index = 0;
+	((bit |= std::is_same_v<T, Extensions> ? 1ull << index : 0ull, ++index), ...);
+	return bit;
+}
+
+template <typename List, typename... Extensions>
+struct ExtensionMask;
+
+template <template <typename...> class List, typename... Ts, typename... Extensions>
+struct ExtensionMask<List<Ts...>, Extensions...>
 {
-	virtual bool Update(float time) = 0;
-	virtual ~IManager() = 0 {};
+	static constexpr unsigned long long value = (ExtensionBit<Ts, Extensions...>() | ... | 0ull);
 };
 
-template <typename... Extensions>
-class Engine
+struct FixedStepConfig
+{
+	float simulation_rate = 100.f;
+	// 0 renders as fast as the main-thread extensions allow (e.g. vsync)
+	float render_rate = 0.f;
+	// Ticks run back to back after a stall before the simulation clock skips ahead
+	unsigned int max_catch_up_steps = 5;
+};
+
+// ManagerSet is either ManagerScheduler (managers added at runtime with AddManager, see
+// Engine) or a StaticManagerSet fixed at compile time (see StaticEngine)
+template <typename ManagerSet, typename... Extensions>
+class BasicEngine
 {
 private:
+	static constexpr bool s_dynamic_managers = std::is_same_v<ManagerSet, ManagerScheduler>;
+
 	std::tuple<std::shared_ptr<Extensions>...> m_extensions;
-	std::vector<std::shared_ptr<IManager>> m_managers;
 	const std::chrono::time_point<std::chrono::steady_clock> time_start_point;
 
 	std::atomic<bool> m_is_active;
+	float m_fixed_time_step = 0.f;
+	std::atomic<unsigned long long> m_frame_index = 0;
+
+	FrameArena m_frame_arena;
+	World m_world;
+	JobSystem m_jobs;
+	EngineContext m_context;
+	ManagerSet m_managers;
+	SchedulingMode m_mode = SchedulingMode::Parallel;
+	std::array<ManagerTiming, sizeof...(Extensions)> m_extension_timings;
+	std::array<const char*, sizeof...(Extensions)> m_extension_profile_names;
+	ManagerTiming m_frame_timing;
+
+	enum class ExtensionGroup
+	{
+		All,
+		MainThread,
+		Background
+	};
+
+	bool UpdateExtensions(float time, ExtensionGroup group)
+	{
+		bool NextUpdate = true;
+		size_t index = 0;
+		std::apply([&](auto&... extension) {
+			auto update = [&](auto& ext) {
+				using T = typename std::decay_t<decltype(ext)>::element_type;
+				bool in_group = group == ExtensionGroup::All || (group == ExtensionGroup::MainThread) == MainThreadExtension<T>;
+				if (in_group && NextUpdate)
+				{
+					ENGINE_PROFILE_SCOPE(m_extension_profile_names[index]);
+					auto start = std::chrono::steady_clock::now();
+					NextUpdate &= ext->Update(time);
+					m_extension_timings[index].Record(std::chrono::steady_clock::now() - start);
+				}
+				++index;
+				};
+			(update(extension), ...);
+			}, m_extensions);
+		return NextUpdate;
+	}
+
+	// Extensions get the context before any manager is constructed
+	ManagerSet CreateManagers()
+	{
+		std::apply([this](auto&... extension) {
+			auto attach = [this](auto& ext) {
+				if constexpr (requires { ext->SetEngineContext(m_context); })
+					ext->SetEngineContext(m_context);
+				};
+			(attach(extension), ...);
+			}, m_extensions);
 
+		if constexpr (s_dynamic_managers)
+			return ManagerSet(m_jobs);
+		else
+			return ManagerSet(m_extensions, GetCurrentTimeStamp(), m_context);
+	}
 public:
-	Engine(std::tuple<std::shared_ptr<Extensions>...> extensions) : 
+	// A fixed time step given here is already in effect while static managers are constructed
+	BasicEngine(std::tuple<std::shared_ptr<Extensions>...> extensions, float fixed_time_step = 0.f) :
+		m_extensions(extensions),
 		time_start_point(std::chrono::steady_clock::now()),
-		m_extensions(extensions)
+		m_fixed_time_step(fixed_time_step),
+		m_context{ m_frame_arena, m_world, m_jobs },
+		m_managers(CreateManagers())
 	{
+		static_assert(sizeof...(Extensions) <= 63, "extension access is tracked in a 64-bit mask, the top bit is the world");
 		m_is_active.store(true);
+		size_t index = 0;
+		((m_extension_timings[index++].name = ReadableTypeName(typeid(Extensions))), ...);
+		for (index = 0; index < m_extension_timings.size(); ++index)
+			m_extension_profile_names[index] = Profiler::Get().Intern(m_extension_timings[index].name);
+		m_frame_timing.name = "Frame";
 	};
 
 	template<typename T>
+		requires s_dynamic_managers
 	std::shared_ptr<T> AddManager()
 	{
-		auto manager = std::make_shared<T>(m_extensions, GetCurrentTimeStamp());
-		m_managers.push_back(manager);
+		std::shared_ptr<T> manager;
+		if constexpr (std::is_constructible_v<T, decltype(m_extensions)&, float, EngineContext&>)
+			manager = std::make_shared<T>(m_extensions, GetCurrentTimeStamp(), m_context);
+		else
+			manager = std::make_shared<T>(m_extensions, GetCurrentTimeStamp());
+		if constexpr (DeclaresAccess<T>)
+			m_managers.Add(manager, ReadableTypeName(typeid(T)),
+				ExtensionMask<typename T::Access::ReadSet, Extensions...>::value,
+				ExtensionMask<typename T::Access::WriteSet, Extensions...>::value);
+		else
+			m_managers.Add(manager, ReadableTypeName(typeid(T)), 0, ~0ull);
 		return manager;
 	}
 
+	template<typename T>
+		requires (!s_dynamic_managers)
+	T& GetManager()
+	{
+		return m_managers.template Get<T>();
+	}
+
 	float GetCurrentTimeStamp() const
 	{
+		if (m_fixed_time_step > 0.f)
+			return m_frame_index.load() * m_fixed_time_step;
 		return std::chrono::duration<float>(std::chrono::steady_clock::now() - time_start_point).count();
 	}
 
@@ -49,19 +176,127 @@ public:
 		return m_is_active.load();
 	}
 
+	// Lets threads waiting on IsActive finish once the caller stops calling Update
+	void Stop()
+	{
+		m_is_active.store(false);
+	}
+
+	// Replaces the wall clock with frame_index * step so Update loops see the same times on every run
+	void SetFixedTimeStep(float step)
+	{
+		m_fixed_time_step = step;
+	}
+
+	EngineContext& GetContext()
+	{
+		return m_context;
+	}
+
+	void SetSchedulingMode(SchedulingMode mode)
+	{
+		m_mode = mode;
+	}
+
+	// Managers in registration order followed by extensions; the last entry is the whole frame
+	std::vector<ManagerTiming> GetTimings() const
+	{
+		std::vector<ManagerTiming> timings;
+		timings.reserve(m_managers.Count() + sizeof...(Extensions) + 1);
+		for (size_t i = 0; i < m_managers.Count(); ++i)
+			timings.push_back(m_managers.GetTiming(i));
+		timings.insert(timings.end(), m_extension_timings.begin(), m_extension_timings.end());
+		timings.push_back(m_frame_timing);
+		return timings;
+	}
+
 	bool Update()
 	{
+		ENGINE_PROFILE_SCOPE("Engine::Update");
+		auto frame_start = std::chrono::steady_clock::now();
 		float time = GetCurrentTimeStamp();
-		bool NextUpdate = true;
-		std::for_each(m_managers.begin(), m_managers.end(), [&NextUpdate, time](auto& obj) {
-			NextUpdate &= obj->Update(time);
-			});
-		std::apply([&NextUpdate, time](auto&... extension) {
-			((NextUpdate &= extension->Update(time)) && ...);
-			}, m_extensions);
+		bool NextUpdate = m_managers.Run(time, m_mode);
+
+		if (m_mode == SchedulingMode::Parallel)
+		{
+			auto background = m_jobs.Async([this, time]() { return UpdateExtensions(time, ExtensionGroup::Background); });
+			NextUpdate &= UpdateExtensions(time, ExtensionGroup::MainThread);
+			NextUpdate &= background.get();
+		}
+		else
+			NextUpdate &= UpdateExtensions(time, ExtensionGroup::All);
 
 		m_is_active.store(NextUpdate);
+		m_frame_arena.Reset();
+		m_frame_timing.Record(std::chrono::steady_clock::now() - frame_start);
+		++m_frame_index;
 
 		return NextUpdate;
 	}
+
+	// Runs managers and background extensions at a fixed rate on a simulation thread while the
+	// calling thread keeps updating main-thread extensions at the render rate. Rendering runs one
+	// simulation step behind so it can interpolate between the two latest snapshots.
+	// The frame arena belongs to the simulation thread in this mode.
+	void Run(const FixedStepConfig& config)
+	{
+		using clock = std::chrono::steady_clock;
+		const float step = 1.f / config.simulation_rate;
+		const auto step_duration = std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(step));
+
+		std::thread simulation([this, &config, step, step_duration]() {
+			float time = GetCurrentTimeStamp();
+			auto next_tick = clock::now();
+			while (IsActive())
+			{
+				unsigned int steps = 0;
+				while (clock::now() >= next_tick && steps < config.max_catch_up_steps && IsActive())
+				{
+					ENGINE_PROFILE_SCOPE("Engine::SimulationStep");
+					auto frame_start = clock::now();
+					bool NextUpdate = m_managers.Run(time, m_mode);
+					NextUpdate &= UpdateExtensions(time, ExtensionGroup::Background);
+					m_frame_arena.Reset();
+					m_frame_timing.Record(clock::now() - frame_start);
+					if (!NextUpdate)
+						m_is_active.store(false);
+
+					// With a fixed time step the clock is the step count, as in Update
+					++m_frame_index;
+					time = m_fixed_time_step > 0.f ? GetCurrentTimeStamp() : time + step;
+					next_tick += step_duration;
+					++steps;
+				}
+				// Still behind after the catch-up steps: the backlog is dropped, a fixed-step clock keeps its time
+				if (clock::now() >= next_tick)
+				{
+					time = GetCurrentTimeStamp();
+					next_tick = clock::now();
+				}
+				std::this_thread::sleep_until(next_tick);
+			}
+			});
+
+		auto next_frame = clock::now();
+		while (IsActive())
+		{
+			ENGINE_PROFILE_SCOPE("Engine::RenderFrame");
+			if (!UpdateExtensions(GetCurrentTimeStamp() - (m_fixed_time_step > 0.f ? m_fixed_time_step : step), ExtensionGroup::MainThread))
+				m_is_active.store(false);
+			if (config.render_rate > 0.f)
+			{
+				next_frame += std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(1.f / config.render_rate));
+				std::this_thread::sleep_until(next_frame);
+			}
+		}
+		simulation.join();
+	}
 };
+
+template <typename... Extensions>
+using Engine = BasicEngine<ManagerScheduler, Extensions...>;
+
+// Engine whose managers are fixed at compile time, e.g.
+// StaticEngine<ManagerList<BulletManager<A, B>, WallManager<A, B>>, A, B>
+template <typename Managers, typename... Extensions>
+using StaticEngine = BasicEngine<StaticManagerSet<Managers, Extensions...>, Extensions...>;
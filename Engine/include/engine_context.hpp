@@ -0,0 +1,13 @@
+#pragma once
+#include "memory/frame_arena.hpp"
+#include "ecs/world.hpp"
+#include "scheduler/job_system.hpp"
+
+// Engine-owned services reachable from managers (constructor taking EngineContext&)
+// and extensions (SetEngineContext(EngineContext&))
+struct EngineContext
+{
+	FrameArena& frame_arena;
+	World& world;
+	JobSystem& jobs;
+};
@@ -4,10 +4,12 @@
 #include <optional>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
 
 #include "graphic_resource.hpp"
 #include "graphic_mesh.hpp"
 #include "fps_counter_renderer.hpp"
+#include "instance_snapshot.hpp"
 
 struct IGraphicEntity
 {
@@ -29,12 +31,16 @@ struct IGraphicEntityInstanced
 
 struct IGraphicManager
 {
+	static constexpr bool s_main_thread_only = true;
+
 	virtual void AddProgram(std::unique_ptr<IProgram> graphic_program, const std::string& shader_name) = 0;
 	virtual void AddMesh(std::unique_ptr<IGraphicMesh> graphic_mesh, const std::string& mesh_name) = 0;
 	virtual unsigned int AddEntity(std::unique_ptr<IGraphicEntity> graphic_entity) = 0;
 	virtual unsigned int AddEntityInstanced(std::unique_ptr<IGraphicEntityInstanced> graphic_entity) = 0;
 	virtual void ChangeEntityTransformation(unsigned int graphic_entity_id, std::unique_ptr<IUniform> transformation) = 0;
 	virtual void ChangeEntityInstanceTransformation(unsigned int graphic_entity_id,std::unique_ptr<IBufferAdapter> transformations) = 0;
+	// Instance transforms of the entity are taken from the latest snapshots, interpolated to the render time
+	virtual void SetEntityInstanceSnapshots(unsigned int graphic_entity_id, std::shared_ptr<InstanceSnapshotBuffer> snapshots) = 0;
 	virtual void DeleteEntity(unsigned int graphic_entity_id) = 0;
 	virtual bool Update(float time) = 0;
 	virtual ~IGraphicManager() {};
@@ -49,6 +55,13 @@ private:
 	std::unordered_map<int, std::unique_ptr<IGraphicEntityInstanced>> m_graphic_entities_instanced;
 	unsigned int m_counter = 0;
 
+	// Managers may run on worker threads, so instance uploads are queued and applied on the GL thread in Update.
+	// Update only holds the lock to take the queue, so entities must be added before the engine starts running.
+	std::mutex m_mutex;
+	std::unordered_map<int, std::unique_ptr<IBufferAdapter>> m_pending_instance_transformations;
+	std::unordered_map<int, std::shared_ptr<InstanceSnapshotBuffer>> m_instance_snapshots;
+	std::vector<glm::mat3> m_interpolated_instances;
+
 	std::unordered_map<std::string, std::unique_ptr<IProgram>> m_graphic_programs;
 	std::unordered_map<std::string, std::unique_ptr<IGraphicMesh>> m_graphic_meshes;
 	std::unique_ptr<IUniform> m_model_transformation;
@@ -81,28 +94,38 @@ public:
 	}
 	unsigned int AddEntity(std::unique_ptr<IGraphicEntity> graphic_entity) override
 	{
+		std::lock_guard lock(m_mutex);
 		++m_counter;
 		m_graphic_entities.emplace(m_counter, std::move(graphic_entity));
 		return m_counter;
 	}
 	unsigned int AddEntityInstanced(std::unique_ptr<IGraphicEntityInstanced> graphic_entity) override
 	{
+		std::lock_guard lock(m_mutex);
 		++m_counter;
 		m_graphic_entities_instanced.emplace(m_counter, std::move(graphic_entity));
 		return m_counter;
 	}
 	void ChangeEntityTransformation(unsigned int graphic_entity_id, std::unique_ptr<IUniform> transformation) override
 	{
+		std::lock_guard lock(m_mutex);
 		m_graphic_entities[graphic_entity_id]->SetTransform(std::move(transformation));
 	}
 	void DeleteEntity(unsigned int graphic_entity_id) override
 	{
+		std::lock_guard lock(m_mutex);
 		m_graphic_entities.erase(graphic_entity_id);
 	}
 
 	void ChangeEntityInstanceTransformation(unsigned int graphic_entity_id, std::unique_ptr<IBufferAdapter> transformations) override
 	{
-		m_graphic_entities_instanced[graphic_entity_id]->SetTransformInstances(std::move(transformations));
+		std::lock_guard lock(m_mutex);
+		m_pending_instance_transformations[graphic_entity_id] = std::move(transformations);
+	}
+	void SetEntityInstanceSnapshots(unsigned int graphic_entity_id, std::shared_ptr<InstanceSnapshotBuffer> snapshots) override
+	{
+		std::lock_guard lock(m_mutex);
+		m_instance_snapshots[graphic_entity_id] = std::move(snapshots);
 	}
 
 	bool Update(float time) override;
@@ -150,17 +173,22 @@ template<typename Coord, typename Index, typename InstanceType, typename... Feat
 class GraphicEntityInstanced final : public IGraphicEntityInstanced
 {
 private:
-	GLGraphicMeshInstanced<Coord, Index, InstanceType, Features...> m_gl_mesh;
+	// GL objects are created on first GetMesh so that entities can be built without a GL context
+	Mesh<Coord, Index, Features...> m_mesh;
+	std::optional<GLGraphicMeshInstanced<Coord, Index, InstanceType, Features...>> m_gl_mesh;
+	std::unique_ptr<IBufferAdapter> m_pending_instances;
 	std::string m_shader_name;
 public:
 
 	GraphicEntityInstanced(const Mesh<Coord, Index, Features...>& mesh, const std::string& shader_name) :
-		m_gl_mesh(mesh, std::make_unique<BufferAdapter<InstanceType>>()),
+		m_mesh(mesh),
 		m_shader_name(shader_name)
 	{}
 	unsigned long long InstanceCount() const noexcept override
 	{
-		return m_gl_mesh.InstanceCount();
+		if (m_gl_mesh)
+			return m_gl_mesh->InstanceCount();
+		return m_pending_instances ? m_pending_instances->Count() : 0;
 	}
 	std::string GetProgram() const noexcept override
 	{
@@ -168,10 +196,19 @@ public:
 	}
 	IGraphicMeshInstanced* GetMesh() override
 	{
-		return &m_gl_mesh;
+		if (!m_gl_mesh)
+		{
+			m_gl_mesh.emplace(m_mesh, std::make_unique<BufferAdapter<InstanceType>>());
+			if (m_pending_instances)
+				m_gl_mesh->UpdateInstanceData(std::move(m_pending_instances));
+		}
+		return &*m_gl_mesh;
 	}
 	void SetTransformInstances(std::unique_ptr<IBufferAdapter> transformations) override
 	{
-		m_gl_mesh.UpdateInstanceData(std::move(transformations));
+		if (m_gl_mesh)
+			m_gl_mesh->UpdateInstanceData(std::move(transformations));
+		else
+			m_pending_instances = std::move(transformations);
 	}
 };
\ No newline at end of file
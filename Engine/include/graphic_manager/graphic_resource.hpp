@@ -49,6 +49,32 @@ public:
 	}
 };
 
+// Non-owning adapter, the data must outlive the CopyBuffer call
+template <typename T>
+class BufferView : public IBufferAdapter
+{
+private:
+	const T* m_data;
+	unsigned long long m_count;
+public:
+	BufferView(const std::vector<T>& data) : m_data(data.data()), m_count(data.size())
+	{}
+
+	unsigned long long Count() const noexcept override
+	{
+		return m_count;
+	}
+	unsigned long long TypeSizeOf() const noexcept override
+	{
+		return sizeof(T);
+	}
+
+	void CopyBuffer() const override
+	{
+		glBufferData(GL_ARRAY_BUFFER, sizeof(T) * m_count, m_data, GL_DYNAMIC_DRAW);
+	}
+};
+
 struct IUniform
 {
 	virtual void Bind(unsigned int handle, const std::string& name) const = 0;
@@ -0,0 +1,99 @@
+#pragma once
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+struct InstanceSnapshot
+{
+	float time = 0.f;
+	std::vector<unsigned int> ids;
+	std::vector<glm::mat3> transforms;
+
+	void Clear(float snapshot_time)
+	{
+		time = snapshot_time;
+		ids.clear();
+		transforms.clear();
+	}
+	// For writers that fill ids and transforms by index, e.g. from parallel chunks
+	void Resize(size_t count)
+	{
+		ids.resize(count);
+		transforms.resize(count);
+	}
+	void Push(unsigned int id, const glm::mat3& transform)
+	{
+		ids.push_back(id);
+		transforms.push_back(transform);
+	}
+};
+
+// Hands instance transforms from the simulation thread to the render thread.
+// The writer fills Back() and publishes it; the reader keeps the two latest published
+// snapshots to interpolate between. Buffers are swapped, never copied, and the lock is only
+// held for the swap, so neither side waits on the other's frame.
+class InstanceSnapshotBuffer
+{
+private:
+	std::mutex m_mutex;
+	InstanceSnapshot m_back;
+	InstanceSnapshot m_pending;
+	bool m_fresh = false;
+	InstanceSnapshot m_current;
+	InstanceSnapshot m_previous;
+	bool m_has_current = false;
+public:
+	// Writer side
+	InstanceSnapshot& Back()
+	{
+		return m_back;
+	}
+	void Publish()
+	{
+		std::lock_guard lock(m_mutex);
+		std::swap(m_back, m_pending);
+		m_fresh = true;
+	}
+
+	// Reader side, returns true when a new snapshot became current
+	bool Acquire()
+	{
+		std::lock_guard lock(m_mutex);
+		if (!m_fresh)
+			return false;
+		std::swap(m_previous, m_current);
+		std::swap(m_current, m_pending);
+		if (!m_has_current)
+			m_previous = m_current;
+		m_has_current = true;
+		m_fresh = false;
+		return true;
+	}
+	const InstanceSnapshot& Current() const
+	{
+		return m_current;
+	}
+	const InstanceSnapshot& Previous() const
+	{
+		return m_previous;
+	}
+
+	// Blends previous and current at the given time; instances that are new in the current
+	// snapshot (or moved to another slot) are taken as is
+	void Interpolate(float time, std::vector<glm::mat3>& out) const
+	{
+		float span = m_current.time - m_previous.time;
+		float alpha = span > 0.f ? std::clamp((time - m_previous.time) / span, 0.f, 1.f) : 1.f;
+
+		out.resize(m_current.transforms.size());
+		for (size_t i = 0; i < m_current.transforms.size(); ++i)
+		{
+			if (alpha < 1.f && i < m_previous.ids.size() && m_previous.ids[i] == m_current.ids[i])
+				out[i] = m_previous.transforms[i] + alpha * (m_current.transforms[i] - m_previous.transforms[i]);
+			else
+				out[i] = m_current.transforms[i];
+		}
+	}
+};
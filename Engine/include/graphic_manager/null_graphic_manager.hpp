@@ -0,0 +1,127 @@
+#pragma once
+#include <mutex>
+#include <unordered_map>
+#include <memory>
+#include <vector>
+#include <utility>
+
+#include "graphic_manager.hpp"
+
+struct NullGraphicStats
+{
+	unsigned long long frames = 0;
+	unsigned long long programs = 0;
+	unsigned long long meshes = 0;
+	unsigned long long entities = 0;
+	unsigned long long instanced_entities = 0;
+	unsigned long long transformation_changes = 0;
+	unsigned long long instance_uploads = 0;
+	unsigned long long uploaded_instances = 0;
+	unsigned long long live_instances = 0;
+};
+
+// Headless backend: accepts the same calls as GLGraphicManager and keeps the submitted
+// resources alive, but only counts them and never touches GL.
+class NullGraphicManager final : public IGraphicManager
+{
+private:
+	std::unordered_map<int, std::unique_ptr<IGraphicEntity>> m_graphic_entities;
+	std::unordered_map<int, std::unique_ptr<IGraphicEntityInstanced>> m_graphic_entities_instanced;
+	std::unordered_map<int, unsigned long long> m_instance_counts;
+	std::unordered_map<int, std::shared_ptr<InstanceSnapshotBuffer>> m_instance_snapshots;
+	unsigned int m_counter = 0;
+	unsigned long long m_frame_limit;
+
+	mutable std::mutex m_mutex;
+	NullGraphicStats m_stats;
+public:
+	// frame_limit == 0 runs until the engine is stopped by something else
+	NullGraphicManager(unsigned long long frame_limit = 0) : m_frame_limit(frame_limit)
+	{}
+
+	void AddProgram(std::unique_ptr<IProgram>, const std::string&) override
+	{
+		std::lock_guard lock(m_mutex);
+		++m_stats.programs;
+	}
+	void AddMesh(std::unique_ptr<IGraphicMesh>, const std::string&) override
+	{
+		std::lock_guard lock(m_mutex);
+		++m_stats.meshes;
+	}
+	unsigned int AddEntity(std::unique_ptr<IGraphicEntity> graphic_entity) override
+	{
+		std::lock_guard lock(m_mutex);
+		++m_counter;
+		m_graphic_entities.emplace(m_counter, std::move(graphic_entity));
+		m_stats.entities = m_graphic_entities.size();
+		return m_counter;
+	}
+	unsigned int AddEntityInstanced(std::unique_ptr<IGraphicEntityInstanced> graphic_entity) override
+	{
+		std::lock_guard lock(m_mutex);
+		++m_counter;
+		m_instance_counts.emplace(m_counter, graphic_entity->InstanceCount());
+		m_stats.live_instances += graphic_entity->InstanceCount();
+		m_graphic_entities_instanced.emplace(m_counter, std::move(graphic_entity));
+		m_stats.instanced_entities = m_graphic_entities_instanced.size();
+		return m_counter;
+	}
+	void ChangeEntityTransformation(unsigned int graphic_entity_id, std::unique_ptr<IUniform> transformation) override
+	{
+		std::lock_guard lock(m_mutex);
+		m_graphic_entities[graphic_entity_id]->SetTransform(std::move(transformation));
+		++m_stats.transformation_changes;
+	}
+	void ChangeEntityInstanceTransformation(unsigned int graphic_entity_id, std::unique_ptr<IBufferAdapter> transformations) override
+	{
+		std::lock_guard lock(m_mutex);
+		auto& count = m_instance_counts[graphic_entity_id];
+		m_stats.live_instances += transformations->Count() - count;
+		count = transformations->Count();
+		++m_stats.instance_uploads;
+		m_stats.uploaded_instances += count;
+	}
+	void SetEntityInstanceSnapshots(unsigned int graphic_entity_id, std::shared_ptr<InstanceSnapshotBuffer> snapshots) override
+	{
+		std::lock_guard lock(m_mutex);
+		m_instance_snapshots[graphic_entity_id] = std::move(snapshots);
+	}
+	void DeleteEntity(unsigned int graphic_entity_id) override
+	{
+		std::lock_guard lock(m_mutex);
+		m_graphic_entities.erase(graphic_entity_id);
+		m_stats.entities = m_graphic_entities.size();
+	}
+	bool Update(float) override
+	{
+		// Same lock scope as GLGraphicManager::Update, so headless runs see the same contention
+		std::vector<std::pair<int, std::shared_ptr<InstanceSnapshotBuffer>>> instance_snapshots;
+		{
+			std::lock_guard lock(m_mutex);
+			instance_snapshots.assign(m_instance_snapshots.begin(), m_instance_snapshots.end());
+		}
+		std::vector<std::pair<int, size_t>> acquired;
+		for (auto& [graphic_entity_id, snapshots] : instance_snapshots)
+			if (snapshots->Acquire())
+				acquired.emplace_back(graphic_entity_id, snapshots->Current().transforms.size());
+
+		std::lock_guard lock(m_mutex);
+		for (auto [graphic_entity_id, size] : acquired)
+		{
+			auto& count = m_instance_counts[graphic_entity_id];
+			m_stats.live_instances += size - count;
+			count = size;
+			++m_stats.instance_uploads;
+			m_stats.uploaded_instances += count;
+		}
+		++m_stats.frames;
+		return m_frame_limit == 0 || m_stats.frames < m_frame_limit;
+	}
+
+	NullGraphicStats GetStats() const
+	{
+		std::lock_guard lock(m_mutex);
+		return m_stats;
+	}
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <typeinfo>
+
+struct IManager
+{
+	virtual bool Update(float time) = 0;
+	virtual ~IManager() = 0 {};
+};
+
+template <typename... Ts>
+struct Reads {};
+
+template <typename... Ts>
+struct Writes {};
+
+// Declared by a manager as `using Access = ManagerAccess<Reads<...>, Writes<...>>;`
+// Managers without an Access declaration are treated as writing every extension.
+template <typename ReadList = Reads<>, typename WriteList = Writes<>>
+struct ManagerAccess
+{
+	using ReadSet = ReadList;
+	using WriteSet = WriteList;
+};
+
+template <typename T>
+concept DeclaresAccess = requires {
+	typename T::Access::ReadSet;
+	typename T::Access::WriteSet;
+};
+
+// Extensions that must be updated on the thread that created them (e.g. the GL context owner)
+template <typename T>
+concept MainThreadExtension = requires { requires T::s_main_thread_only; };
+
+enum class SchedulingMode
+{
+	Serial,
+	Parallel
+};
+
+// Type name for timings and traces, demangled where typeid gives a mangled one
+std::string ReadableTypeName(const std::type_info& type);
+
+struct ManagerTiming
+{
+	std::string name;
+	float last_ms = 0.f;
+	float average_ms = 0.f;
+
+	void Record(std::chrono::steady_clock::duration elapsed)
+	{
+		last_ms = std::chrono::duration<float, std::milli>(elapsed).count();
+		average_ms = average_ms == 0.f ? last_ms : average_ms + 0.05f * (last_ms - average_ms);
+	}
+};
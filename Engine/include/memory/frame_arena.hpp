@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <new>
+#include <unordered_set>
+
+// Linear allocator for data that lives at most until the end of the current frame.
+// Allocation is a lock-free bump of the current block; a new block is taken only when it
+// is exhausted. Reset (called by the engine at the end of a frame) releases everything at
+// once and folds the blocks used during the frame into one, so a steady workload ends up
+// with a single block and no heap traffic.
+class FrameArena
+{
+private:
+	struct Block
+	{
+		std::unique_ptr<std::byte[]> data;
+		size_t size;
+		std::atomic<size_t> offset = 0;
+		Block(size_t block_size) : data(new std::byte[block_size]), size(block_size)
+		{}
+	};
+	std::vector<std::unique_ptr<Block>> m_blocks;
+	std::atomic<Block*> m_current;
+	std::mutex m_mutex;
+public:
+	FrameArena(size_t initial_size = 1 << 20);
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment);
+	// Must not race with Allocate; everything allocated before is invalidated
+	void Reset();
+
+	size_t Capacity() const;
+	size_t UsedBytes() const;
+};
+
+// Falls back to the global heap when no arena is given, so containers stay usable before an
+// engine context is attached. Deallocation into the arena is a no-op.
+template <typename T>
+class FrameAllocator
+{
+private:
+	template <typename U>
+	friend class FrameAllocator;
+	FrameArena* m_arena;
+public:
+	using value_type = T;
+
+	FrameAllocator(FrameArena* arena = nullptr) noexcept : m_arena(arena)
+	{}
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>& other) noexcept : m_arena(other.m_arena)
+	{}
+
+	T* allocate(size_t n)
+	{
+		if (m_arena)
+			return static_cast<T*>(m_arena->Allocate(n * sizeof(T), alignof(T)));
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+	void deallocate(T* p, size_t) noexcept
+	{
+		if (!m_arena)
+			::operator delete(p);
+	}
+
+	template <typename U>
+	bool operator==(const FrameAllocator<U>& other) const noexcept
+	{
+		return m_arena == other.m_arena;
+	}
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+template <typename T, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>>
+using FrameUnorderedSet = std::unordered_set<T, Hash, Equal, FrameAllocator<T>>;
@@ -0,0 +1,83 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <deque>
+
+struct ProfileEvent
+{
+	const char* name;
+	long long start_ns;
+	long long duration_ns;
+};
+
+// Collects scoped zones per thread and writes them as Chrome trace JSON
+// (chrome://tracing, ui.perfetto.dev). Zone names must outlive the recording;
+// use Intern for names built at runtime.
+class Profiler
+{
+private:
+	struct ThreadBuffer
+	{
+		std::mutex mutex;
+		std::vector<ProfileEvent> events;
+		unsigned int thread_id;
+	};
+
+	std::mutex m_mutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+	std::deque<std::string> m_interned;
+	std::atomic<bool> m_recording = false;
+	std::atomic<size_t> m_max_events_per_thread = 1 << 22;
+	const std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+
+	Profiler() = default;
+	ThreadBuffer& GetThreadBuffer();
+public:
+	static Profiler& Get();
+
+	void Start(size_t max_events_per_thread = 1 << 22);
+	void Stop();
+	bool IsRecording() const noexcept
+	{
+		return m_recording.load(std::memory_order_relaxed);
+	}
+
+	long long Now() const noexcept
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+	}
+	void Record(const ProfileEvent& event);
+	const char* Intern(const std::string& name);
+
+	bool WriteChromeTrace(const std::string& path);
+};
+
+class ProfileScope
+{
+private:
+	const char* m_name;
+	long long m_start;
+public:
+	ProfileScope(const char* name) : m_name(name), m_start(Profiler::Get().IsRecording() ? Profiler::Get().Now() : -1)
+	{}
+	~ProfileScope()
+	{
+		if (m_start >= 0)
+			Profiler::Get().Record({ m_name, m_start, Profiler::Get().Now() - m_start });
+	}
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define ENGINE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ENGINE_PROFILE_CONCAT(a, b) ENGINE_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef ENGINE_PROFILING
+#define ENGINE_PROFILE_SCOPE(name) ProfileScope ENGINE_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#else
+#define ENGINE_PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <algorithm>
+
+// Work-stealing thread pool. Every worker owns a deque: it pushes and pops its own jobs at
+// the back while idle workers steal from the front of the others. Jobs submitted from
+// outside the pool go to a shared injection queue. Threads waiting on jobs (TaskGroup::Wait,
+// ParallelFor) run pending jobs instead of blocking, so jobs may wait on nested jobs.
+class JobSystem
+{
+private:
+	struct JobQueue
+	{
+		std::mutex mutex;
+		std::deque<std::function<void()>> jobs;
+	};
+	std::vector<std::thread> m_workers;
+	// One queue per worker followed by the injection queue
+	std::vector<std::unique_ptr<JobQueue>> m_queues;
+	std::atomic<size_t> m_queued = 0;
+	std::mutex m_sleep_mutex;
+	std::condition_variable m_wake;
+	bool m_stop = false;
+	std::atomic<bool> m_deterministic = false;
+
+	void WorkerLoop(unsigned int index);
+	bool PopLocal(std::function<void()>& job);
+	bool Steal(std::function<void()>& job);
+public:
+	JobSystem(unsigned int thread_count = DefaultThreadCount());
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	static unsigned int DefaultThreadCount()
+	{
+		unsigned int hardware_threads = std::thread::hardware_concurrency();
+		return hardware_threads > 1 ? hardware_threads - 1 : 1;
+	}
+
+	unsigned int ThreadCount() const noexcept
+	{
+		return static_cast<unsigned int>(m_workers.size());
+	}
+
+	// Index of the calling worker in [0, ThreadCount()); threads outside the pool get ThreadCount()
+	unsigned int WorkerIndex() const noexcept;
+
+	// Runs every job inline on the submitting thread in submission order, for debugging
+	void SetDeterministic(bool deterministic)
+	{
+		m_deterministic.store(deterministic);
+	}
+	bool IsDeterministic() const noexcept
+	{
+		return m_deterministic.load();
+	}
+
+	void Submit(std::function<void()> job);
+
+	// Runs one pending job on the calling thread, returns false if there was none
+	bool RunPendingJob();
+
+	template <typename F>
+	auto Async(F&& function) -> std::future<std::invoke_result_t<F>>
+	{
+		auto task = std::make_shared<std::packaged_task<std::invoke_result_t<F>()>>(std::forward<F>(function));
+		auto result = task->get_future();
+		Submit([task]() { (*task)(); });
+		return result;
+	}
+
+	// function(begin, end) over chunks of at least grain indices; returns when all are done
+	template <typename F>
+	void ParallelForRange(size_t begin, size_t end, size_t grain, F&& function);
+
+	// function(i) for every i in [begin, end)
+	template <typename F>
+	void ParallelFor(size_t begin, size_t end, F&& function, size_t grain = 256)
+	{
+		ParallelForRange(begin, end, grain, [&function](size_t chunk_begin, size_t chunk_end) {
+			for (size_t i = chunk_begin; i < chunk_end; ++i)
+				function(i);
+			});
+	}
+
+	~JobSystem();
+};
+
+// Set of jobs that can be waited on together. Continuations added with Then are submitted
+// once every job run so far has finished and are part of the group themselves.
+class TaskGroup
+{
+private:
+	JobSystem& m_jobs;
+	std::mutex m_mutex;
+	size_t m_pending = 0;
+	std::vector<std::function<void()>> m_continuations;
+
+	void Finish();
+public:
+	TaskGroup(JobSystem& jobs) : m_jobs(jobs)
+	{}
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup& operator=(const TaskGroup&) = delete;
+
+	void Run(std::function<void()> job);
+	void Then(std::function<void()> continuation);
+	// Helps with pending jobs until the group is done
+	void Wait();
+
+	~TaskGroup()
+	{
+		Wait();
+	}
+};
+
+template <typename F>
+void JobSystem::ParallelForRange(size_t begin, size_t end, size_t grain, F&& function)
+{
+	if (begin >= end)
+		return;
+	size_t count = end - begin;
+	size_t chunks = std::min<size_t>((count + std::max<size_t>(grain, 1) - 1) / std::max<size_t>(grain, 1), 4 * (ThreadCount() + 1));
+	if (chunks <= 1 || IsDeterministic())
+	{
+		function(begin, end);
+		return;
+	}
+
+	size_t chunk_size = (count + chunks - 1) / chunks;
+	TaskGroup group(*this);
+	for (size_t chunk_begin = begin + chunk_size; chunk_begin < end; chunk_begin += chunk_size)
+		group.Run([&function, chunk_begin, chunk_end = std::min(chunk_begin + chunk_size, end)]() {
+			function(chunk_begin, chunk_end);
+			});
+	function(begin, begin + chunk_size);
+	group.Wait();
+}
+
+// One T per worker plus one shared by threads outside the pool, e.g. scratch buffers filled
+// by ParallelFor chunks and merged afterwards
+template <typename T>
+class PerWorker
+{
+private:
+	JobSystem& m_jobs;
+	std::vector<T> m_slots;
+public:
+	PerWorker(JobSystem& jobs) : m_jobs(jobs), m_slots(jobs.ThreadCount() + 1)
+	{}
+
+	T& Local()
+	{
+		return m_slots[m_jobs.WorkerIndex()];
+	}
+
+	template <typename F>
+	void ForEach(F&& function)
+	{
+		std::for_each(m_slots.begin(), m_slots.end(), std::forward<F>(function));
+	}
+};
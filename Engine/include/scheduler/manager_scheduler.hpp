@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+
+#include "manager.hpp"
+#include "scheduler/job_system.hpp"
+
+// Runs managers as a dependency graph built from their declared extension access.
+// A manager depends on every earlier manager it conflicts with (write/write or read/write
+// on the same extension), so independent managers run concurrently while conflicting ones
+// keep their registration order.
+class ManagerScheduler
+{
+private:
+	struct Node
+	{
+		std::shared_ptr<IManager> manager;
+		unsigned long long reads = 0;
+		unsigned long long writes = 0;
+		std::vector<size_t> successors{};
+		size_t dependency_count = 0;
+		ManagerTiming timing{};
+		const char* profile_name = nullptr;
+	};
+	std::vector<Node> m_nodes;
+	size_t m_critical_path = 0;
+	JobSystem& m_jobs;
+
+	bool RunNode(Node& node, float time);
+	bool RunSerial(float time);
+	bool RunParallel(float time);
+public:
+	ManagerScheduler(JobSystem& jobs) : m_jobs(jobs)
+	{}
+
+	void Add(std::shared_ptr<IManager> manager, std::string name, unsigned long long reads, unsigned long long writes);
+	bool Run(float time, SchedulingMode mode);
+
+	size_t Count() const noexcept
+	{
+		return m_nodes.size();
+	}
+	const ManagerTiming& GetTiming(size_t index) const
+	{
+		return m_nodes[index].timing;
+	}
+	// Length of the longest chain of dependent managers
+	size_t CriticalPathLength() const noexcept
+	{
+		return m_critical_path;
+	}
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <memory>
+#include <chrono>
+#include <concepts>
+#include <typeinfo>
+
+#include "manager.hpp"
+#include "engine_context.hpp"
+#include "profiler/profiler.hpp"
+
+// Compile-time manager list for StaticEngine
+template <typename... Managers>
+struct ManagerList
+{};
+
+template <typename Manager>
+struct ManagerSlot
+{
+	Manager manager;
+
+	template <typename Tuple>
+		requires std::constructible_from<Manager, const Tuple&, float, EngineContext&>
+	ManagerSlot(const Tuple& extensions, float time, EngineContext& context) :
+		manager(extensions, time, context)
+	{}
+	template <typename Tuple>
+		requires (!std::constructible_from<Manager, const Tuple&, float, EngineContext&>)
+	ManagerSlot(const Tuple& extensions, float time, EngineContext&) :
+		manager(extensions, time)
+	{}
+};
+
+template <typename List, typename... Extensions>
+class StaticManagerSet;
+
+// Managers stored by value, each constructed in place (they need not be movable), and
+// updated in declaration order by a fold expression. The concrete type of every manager is
+// known here, so Update is called directly rather than through IManager's vtable.
+template <typename... Managers, typename... Extensions>
+class StaticManagerSet<ManagerList<Managers...>, Extensions...> : private ManagerSlot<Managers>...
+{
+private:
+	std::array<ManagerTiming, sizeof...(Managers)> m_timings;
+	std::array<const char*, sizeof...(Managers)> m_profile_names;
+
+	template <typename Manager>
+	bool RunManager(size_t index, float time)
+	{
+		ENGINE_PROFILE_SCOPE(m_profile_names[index]);
+		auto start = std::chrono::steady_clock::now();
+		bool result = static_cast<ManagerSlot<Manager>&>(*this).manager.Update(time);
+		m_timings[index].Record(std::chrono::steady_clock::now() - start);
+		return result;
+	}
+public:
+	StaticManagerSet(const std::tuple<std::shared_ptr<Extensions>...>& extensions, float time, EngineContext& context) :
+		ManagerSlot<Managers>(extensions, time, context)...
+	{
+		size_t index = 0;
+		((m_timings[index++].name = ReadableTypeName(typeid(Managers))), ...);
+		for (index = 0; index < m_timings.size(); ++index)
+			m_profile_names[index] = Profiler::Get().Intern(m_timings[index].name);
+	}
+	StaticManagerSet(const StaticManagerSet&) = delete;
+	StaticManagerSet& operator=(const StaticManagerSet&) = delete;
+
+	template <typename Manager>
+	Manager& Get()
+	{
+		return static_cast<ManagerSlot<Manager>&>(*this).manager;
+	}
+
+	// Always runs in declaration order; the scheduling mode only applies to extensions
+	bool Run(float time, SchedulingMode)
+	{
+		bool result = true;
+		size_t index = 0;
+		((result &= RunManager<Managers>(index++, time)), ...);
+		return result;
+	}
+
+	static constexpr size_t Count() noexcept
+	{
+		return sizeof...(Managers);
+	}
+	const ManagerTiming& GetTiming(size_t index) const
+	{
+		return m_timings[index];
+	}
+};
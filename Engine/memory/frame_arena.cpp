@@ -0,0 +1,57 @@
+#include "memory/frame_arena.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+FrameArena::FrameArena(size_t initial_size)
+{
+	m_blocks.push_back(std::make_unique<Block>(initial_size));
+	m_current.store(m_blocks.back().get());
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	while (true)
+	{
+		Block* block = m_current.load(std::memory_order_acquire);
+		size_t offset = block->offset.fetch_add(size + alignment - 1, std::memory_order_relaxed);
+		if (offset + size + alignment - 1 <= block->size)
+		{
+			auto address = reinterpret_cast<std::uintptr_t>(block->data.get() + offset);
+			return reinterpret_cast<void*>((address + alignment - 1) & ~(alignment - 1));
+		}
+
+		std::lock_guard lock(m_mutex);
+		if (m_current.load(std::memory_order_relaxed) == block)
+		{
+			m_blocks.push_back(std::make_unique<Block>(std::max(block->size * 2, size + alignment)));
+			m_current.store(m_blocks.back().get(), std::memory_order_release);
+		}
+	}
+}
+
+void FrameArena::Reset()
+{
+	if (m_blocks.size() > 1)
+	{
+		size_t total = std::accumulate(m_blocks.begin(), m_blocks.end(), size_t(0),
+			[](size_t sum, const auto& block) { return sum + block->size; });
+		m_blocks.clear();
+		m_blocks.push_back(std::make_unique<Block>(total));
+		m_current.store(m_blocks.back().get());
+	}
+	else
+		m_blocks.back()->offset.store(0);
+}
+
+size_t FrameArena::Capacity() const
+{
+	return std::accumulate(m_blocks.begin(), m_blocks.end(), size_t(0),
+		[](size_t sum, const auto& block) { return sum + block->size; });
+}
+
+size_t FrameArena::UsedBytes() const
+{
+	return std::accumulate(m_blocks.begin(), m_blocks.end(), size_t(0),
+		[](size_t sum, const auto& block) { return sum + std::min(block->offset.load(), block->size); });
+}
@@ -0,0 +1,98 @@
+#include "profiler/profiler.hpp"
+
+#include <fstream>
+#include <algorithm>
+
+Profiler& Profiler::Get()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::ThreadBuffer& Profiler::GetThreadBuffer()
+{
+	thread_local std::shared_ptr<ThreadBuffer> buffer;
+	if (!buffer)
+	{
+		buffer = std::make_shared<ThreadBuffer>();
+		std::lock_guard lock(m_mutex);
+		buffer->thread_id = static_cast<unsigned int>(m_buffers.size());
+		m_buffers.push_back(buffer);
+	}
+	return *buffer;
+}
+
+void Profiler::Start(size_t max_events_per_thread)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_max_events_per_thread.store(max_events_per_thread, std::memory_order_relaxed);
+		for (auto& buffer : m_buffers)
+		{
+			std::lock_guard buffer_lock(buffer->mutex);
+			buffer->events.clear();
+		}
+	}
+	m_recording.store(true);
+}
+
+void Profiler::Stop()
+{
+	m_recording.store(false);
+}
+
+void Profiler::Record(const ProfileEvent& event)
+{
+	ThreadBuffer& buffer = GetThreadBuffer();
+	std::lock_guard lock(buffer.mutex);
+	if (buffer.events.size() < m_max_events_per_thread.load(std::memory_order_relaxed))
+		buffer.events.push_back(event);
+}
+
+const char* Profiler::Intern(const std::string& name)
+{
+	std::lock_guard lock(m_mutex);
+	auto it = std::find(m_interned.begin(), m_interned.end(), name);
+	if (it != m_interned.end())
+		return it->c_str();
+	return m_interned.emplace_back(name).c_str();
+}
+
+static void WriteJsonString(std::ofstream& out, const char* str)
+{
+	out << '"';
+	for (; *str; ++str)
+	{
+		if (*str == '"' || *str == '\\')
+			out << '\\';
+		if (static_cast<unsigned char>(*str) >= 0x20)
+			out << *str;
+	}
+	out << '"';
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path)
+{
+	std::ofstream out(path);
+	if (!out)
+		return false;
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	std::lock_guard lock(m_mutex);
+	for (auto& buffer : m_buffers)
+	{
+		std::lock_guard buffer_lock(buffer->mutex);
+		for (const auto& event : buffer->events)
+		{
+			out << (first ? "\n" : ",\n") << "{\"name\":";
+			WriteJsonString(out, event.name);
+			out << ",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id
+				<< ",\"ts\":" << event.start_ns / 1000 << '.' << (event.start_ns % 1000) / 100
+				<< ",\"dur\":" << event.duration_ns / 1000 << '.' << (event.duration_ns % 1000) / 100 << '}';
+			first = false;
+		}
+	}
+	out << "\n]}\n";
+	return static_cast<bool>(out);
+}
@@ -0,0 +1,175 @@
+#include "scheduler/job_system.hpp"
+
+namespace
+{
+	thread_local const JobSystem* t_owner = nullptr;
+	thread_local unsigned int t_index = 0;
+}
+
+JobSystem::JobSystem(unsigned int thread_count)
+{
+	for (unsigned int i = 0; i <= thread_count; ++i)
+		m_queues.push_back(std::make_unique<JobQueue>());
+	m_workers.reserve(thread_count);
+	for (unsigned int i = 0; i < thread_count; ++i)
+		m_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+unsigned int JobSystem::WorkerIndex() const noexcept
+{
+	return t_owner == this ? t_index : ThreadCount();
+}
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+	t_owner = this;
+	t_index = index;
+	while (true)
+	{
+		std::function<void()> job;
+		if (PopLocal(job) || Steal(job))
+		{
+			job();
+			continue;
+		}
+		std::unique_lock lock(m_sleep_mutex);
+		m_wake.wait(lock, [this]() { return m_stop || m_queued.load() > 0; });
+		if (m_stop && m_queued.load() == 0)
+			return;
+	}
+}
+
+bool JobSystem::PopLocal(std::function<void()>& job)
+{
+	if (t_owner != this)
+		return false;
+	JobQueue& queue = *m_queues[t_index];
+	std::lock_guard lock(queue.mutex);
+	if (queue.jobs.empty())
+		return false;
+	job = std::move(queue.jobs.back());
+	queue.jobs.pop_back();
+	--m_queued;
+	return true;
+}
+
+bool JobSystem::Steal(std::function<void()>& job)
+{
+	if (m_queued.load() == 0)
+		return false;
+	// Start next to the caller so thieves spread over the victims
+	size_t start = WorkerIndex() + 1;
+	for (size_t i = 0; i < m_queues.size(); ++i)
+	{
+		JobQueue& queue = *m_queues[(start + i) % m_queues.size()];
+		std::lock_guard lock(queue.mutex);
+		if (queue.jobs.empty())
+			continue;
+		job = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+		--m_queued;
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::Submit(std::function<void()> job)
+{
+	if (IsDeterministic())
+	{
+		job();
+		return;
+	}
+	{
+		JobQueue& queue = *m_queues[WorkerIndex()];
+		std::lock_guard lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+		++m_queued;
+	}
+	// Taking the sleep mutex orders the push before a worker's wait predicate check
+	{
+		std::lock_guard lock(m_sleep_mutex);
+	}
+	m_wake.notify_one();
+}
+
+bool JobSystem::RunPendingJob()
+{
+	std::function<void()> job;
+	if (!PopLocal(job) && !Steal(job))
+		return false;
+	job();
+	return true;
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard lock(m_sleep_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (auto& worker : m_workers)
+		worker.join();
+}
+
+void TaskGroup::Run(std::function<void()> job)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		++m_pending;
+	}
+	m_jobs.Submit([this, job = std::move(job)]() {
+		job();
+		Finish();
+		});
+}
+
+void TaskGroup::Then(std::function<void()> continuation)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		if (m_pending > 0)
+		{
+			m_continuations.push_back(std::move(continuation));
+			return;
+		}
+	}
+	Run(std::move(continuation));
+}
+
+void TaskGroup::Finish()
+{
+	std::vector<std::function<void()>> continuations;
+	{
+		std::lock_guard lock(m_mutex);
+		if (m_pending == 1 && !m_continuations.empty())
+		{
+			// The continuations take over this job's count so Wait never sees the group idle in between
+			continuations = std::move(m_continuations);
+			m_continuations.clear();
+			m_pending += continuations.size();
+		}
+		--m_pending;
+	}
+	for (auto& continuation : continuations)
+		m_jobs.Submit([this, continuation = std::move(continuation)]() {
+			continuation();
+			Finish();
+			});
+}
+
+void TaskGroup::Wait()
+{
+	while (true)
+	{
+		{
+			// Finish releases the lock last, so the group may be destroyed as soon as this sees it idle
+			std::lock_guard lock(m_mutex);
+			if (m_pending == 0)
+				return;
+		}
+		if (!m_jobs.RunPendingJob())
+			std::this_thread::yield();
+	}
+}
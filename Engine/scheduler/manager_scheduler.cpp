@@ -0,0 +1,121 @@
+#include "scheduler/manager_scheduler.hpp"
+#include "profiler/profiler.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <exception>
+
+void ManagerScheduler::Add(std::shared_ptr<IManager> manager, std::string name, unsigned long long reads, unsigned long long writes)
+{
+	Node node{ .manager = std::move(manager), .reads = reads, .writes = writes };
+	node.timing.name = std::move(name);
+	node.profile_name = Profiler::Get().Intern(node.timing.name);
+	size_t index = m_nodes.size();
+	for (size_t i = 0; i < index; ++i)
+	{
+		Node& prev = m_nodes[i];
+		bool conflict = (prev.writes & (node.reads | node.writes)) || (prev.reads & node.writes);
+		if (conflict)
+		{
+			prev.successors.push_back(index);
+			++node.dependency_count;
+		}
+	}
+	m_nodes.push_back(std::move(node));
+
+	std::vector<size_t> depth(m_nodes.size(), 1);
+	m_critical_path = 0;
+	for (size_t i = 0; i < m_nodes.size(); ++i)
+	{
+		for (size_t successor : m_nodes[i].successors)
+			depth[successor] = std::max(depth[successor], depth[i] + 1);
+		m_critical_path = std::max(m_critical_path, depth[i]);
+	}
+}
+
+bool ManagerScheduler::RunNode(Node& node, float time)
+{
+	ENGINE_PROFILE_SCOPE(node.profile_name);
+	auto start = std::chrono::steady_clock::now();
+	bool result = node.manager->Update(time);
+	node.timing.Record(std::chrono::steady_clock::now() - start);
+	return result;
+}
+
+bool ManagerScheduler::RunSerial(float time)
+{
+	bool result = true;
+	for (auto& node : m_nodes)
+		result &= RunNode(node, time);
+	return result;
+}
+
+bool ManagerScheduler::RunParallel(float time)
+{
+	std::vector<size_t> pending(m_nodes.size());
+	std::transform(m_nodes.begin(), m_nodes.end(), pending.begin(), [](const Node& node) { return node.dependency_count; });
+
+	std::atomic<bool> result = true;
+	size_t finished = 0;
+	std::mutex mutex;
+	std::condition_variable done;
+	// First exception thrown by a manager; managers not started yet are skipped, but their jobs
+	// still finish so the wait below ends, and it is rethrown after it
+	std::exception_ptr error;
+	std::atomic<bool> failed = false;
+
+	std::function<void(size_t)> launch = [&](size_t index) {
+		m_jobs.Submit([&, index]() {
+			Node& node = m_nodes[index];
+			if (!failed.load())
+			{
+				try
+				{
+					if (!RunNode(node, time))
+						result.store(false);
+				}
+				catch (...)
+				{
+					std::lock_guard lock(mutex);
+					if (!error)
+						error = std::current_exception();
+					failed.store(true);
+				}
+			}
+
+			std::vector<size_t> ready;
+			{
+				std::lock_guard lock(mutex);
+				for (size_t successor : node.successors)
+					if (--pending[successor] == 0)
+						ready.push_back(successor);
+			}
+			for (size_t successor : ready)
+				launch(successor);
+
+			std::lock_guard lock(mutex);
+			++finished;
+			done.notify_one();
+			});
+		};
+
+	// pending is already being decremented by the launched jobs, so roots come from the graph
+	for (size_t i = 0; i < m_nodes.size(); ++i)
+		if (m_nodes[i].dependency_count == 0)
+			launch(i);
+
+	std::unique_lock lock(mutex);
+	done.wait(lock, [&]() { return finished == m_nodes.size(); });
+	if (error)
+		std::rethrow_exception(error);
+	return result.load();
+}
+
+bool ManagerScheduler::Run(float time, SchedulingMode mode)
+{
+	if (mode == SchedulingMode::Serial || m_nodes.size() < 2 || CriticalPathLength() == m_nodes.size())
+		return RunSerial(time);
+	return RunParallel(time);
+}